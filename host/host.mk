@@ -0,0 +1,100 @@
+#---------------------------------------------------------------------------------
+# Host (Linux/macOS) headless build, included by the top level Makefile for the
+# "host" goals. Builds the engine sources against the libctru/citro3d stand-ins in
+# host/include, and links them with the headless driver in host/source/main.cpp.
+#
+# make host         Builds $(HOST_BUILD)/$(HOST_TARGET).
+# make host-run     Builds, then runs it. Pass driver options with HOST_ARGS="...".
+# make host-clean   Removes $(HOST_BUILD).
+# make host-tools   Builds the asset tools, e.g. $(HOST_BUILD)/meshconv, the math benchmark $(HOST_BUILD)/mathbench,
+#                   and the physics sleep check $(HOST_BUILD)/sleepcheck.
+# make host-assets  Converts assets/*.obj to romfs/*.mesh with meshconv.
+#
+# RELEASE=1 builds without debug only code, like the main Makefile. Run make host-clean when switching.
+#---------------------------------------------------------------------------------
+HOST_TARGET	:=	$(notdir $(CURDIR))-host
+HOST_BUILD	:=	build-host
+HOST_SOURCES	:=	source \
+				source/utility \
+				source/engine \
+				source/entity \
+				host/source
+
+HOST_CXX	?=	g++
+HOST_CXXFLAGS	:=	-g -Wall -O2 -std=c++14 -fno-rtti -fno-exceptions -pthread \
+				-Ihost/include -MMD -MP
+HOST_LDFLAGS	:=	-g -pthread
+
+ifneq ($(RELEASE),)
+HOST_CXXFLAGS	+=	-DNDEBUG
+endif
+HOST_LIBS	:=	-lm
+
+#---------------------------------------------------------------------------------
+# source/main.cpp is the device entry point. The headless driver replaces it.
+#---------------------------------------------------------------------------------
+HOST_CPPFILES	:=	$(filter-out source/main.cpp,$(foreach dir,$(HOST_SOURCES),$(wildcard $(dir)/*.cpp)))
+HOST_OFILES	:=	$(addprefix $(HOST_BUILD)/,$(HOST_CPPFILES:.cpp=.o))
+
+#---------------------------------------------------------------------------------
+# Asset tools run on the build machine. They share the mesh packing code with the engine.
+#---------------------------------------------------------------------------------
+HOST_MESHCONV	:=	$(HOST_BUILD)/meshconv
+HOST_MESHCONV_OFILES	:=	$(HOST_BUILD)/tools/meshconv.o $(HOST_BUILD)/source/engine/meshformat.o
+HOST_ASSETS	:=	$(patsubst assets/%.obj,romfs/%.mesh,$(wildcard assets/*.obj))
+
+#---------------------------------------------------------------------------------
+# Microbenchmarks of the batched math kernels against their scalar reference. See tools/mathbench.cpp.
+#---------------------------------------------------------------------------------
+HOST_MATHBENCH	:=	$(HOST_BUILD)/mathbench
+HOST_MATHBENCH_OFILES	:=	$(HOST_BUILD)/tools/mathbench.o $(HOST_BUILD)/source/engine/batchmath.o $(HOST_BUILD)/host/source/citro3d.o
+
+#---------------------------------------------------------------------------------
+# Checks of the physics bodies' sleeping and waking, on the pools and collision world alone. See tools/sleepcheck.cpp.
+#---------------------------------------------------------------------------------
+HOST_SLEEPCHECK	:=	$(HOST_BUILD)/sleepcheck
+HOST_SLEEPCHECK_OFILES	:=	$(HOST_BUILD)/tools/sleepcheck.o $(HOST_BUILD)/source/engine/collision.o $(HOST_BUILD)/source/engine/pool.o \
+				$(HOST_BUILD)/source/engine/handle.o $(HOST_BUILD)/source/engine/component.o \
+				$(HOST_BUILD)/source/engine/batchmath.o $(HOST_BUILD)/host/source/citro3d.o
+
+.PHONY: host host-run host-clean host-tools host-assets
+
+host: $(HOST_BUILD)/$(HOST_TARGET)
+
+host-run: host
+	@./$(HOST_BUILD)/$(HOST_TARGET) $(HOST_ARGS)
+
+host-clean:
+	@echo "... host clean ..."
+	@rm -fr $(HOST_BUILD)
+
+host-tools: $(HOST_MESHCONV) $(HOST_MATHBENCH) $(HOST_SLEEPCHECK)
+
+host-assets: $(HOST_ASSETS)
+
+$(HOST_MESHCONV): $(HOST_MESHCONV_OFILES)
+	@echo linking $(notdir $@)
+	@$(HOST_CXX) $(HOST_LDFLAGS) $^ $(HOST_LIBS) -o $@
+
+$(HOST_MATHBENCH): $(HOST_MATHBENCH_OFILES)
+	@echo linking $(notdir $@)
+	@$(HOST_CXX) $(HOST_LDFLAGS) $^ $(HOST_LIBS) -o $@
+
+$(HOST_SLEEPCHECK): $(HOST_SLEEPCHECK_OFILES)
+	@echo linking $(notdir $@)
+	@$(HOST_CXX) $(HOST_LDFLAGS) $^ $(HOST_LIBS) -o $@
+
+romfs/%.mesh: assets/%.obj $(HOST_MESHCONV)
+	@mkdir -p $(dir $@)
+	@./$(HOST_MESHCONV) $< $@
+
+$(HOST_BUILD)/$(HOST_TARGET): $(HOST_OFILES)
+	@echo linking $(notdir $@)
+	@$(HOST_CXX) $(HOST_LDFLAGS) $^ $(HOST_LIBS) -o $@
+
+$(HOST_BUILD)/%.o: %.cpp
+	@echo $(notdir $<)
+	@mkdir -p $(dir $@)
+	@$(HOST_CXX) $(HOST_CXXFLAGS) -c $< -o $@
+
+-include $(HOST_OFILES:.o=.d) $(HOST_BUILD)/tools/meshconv.d $(HOST_BUILD)/tools/mathbench.d $(HOST_BUILD)/tools/sleepcheck.d
@@ -0,0 +1,272 @@
+#pragma once
+
+#ifndef HOST_3DS_HEADER
+#	define HOST_3DS_HEADER
+
+//Host stand-in for the parts of libctru the engine uses. Only compiled by "make host".
+//Types and constants mirror libctru, so the engine sources build unchanged. Services that
+//need hardware (graphics, HID, APT) are no-ops, and input is fed in by the headless driver.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef int64_t s64;
+typedef s32 Result;
+
+#define BIT(n) (1U<<(n))
+#define U64_MAX UINT64_MAX
+
+//System tick frequency of the ARM11 on real hardware. The host tick counter runs at this rate too.
+#define SYSCLOCK_ARM11 268111856
+
+//------------------------------------------------------------------------------------
+// HID
+
+enum {
+	KEY_A       = BIT(0),
+	KEY_B       = BIT(1),
+	KEY_SELECT  = BIT(2),
+	KEY_START   = BIT(3),
+	KEY_DRIGHT  = BIT(4),
+	KEY_DLEFT   = BIT(5),
+	KEY_DUP     = BIT(6),
+	KEY_DDOWN   = BIT(7),
+	KEY_R       = BIT(8),
+	KEY_L       = BIT(9),
+	KEY_X       = BIT(10),
+	KEY_Y       = BIT(11),
+	KEY_ZL      = BIT(14),
+	KEY_ZR      = BIT(15),
+	KEY_TOUCH   = BIT(20),
+	KEY_CSTICK_RIGHT = BIT(24),
+	KEY_CSTICK_LEFT  = BIT(25),
+	KEY_CSTICK_UP    = BIT(26),
+	KEY_CSTICK_DOWN  = BIT(27),
+	KEY_CPAD_RIGHT = BIT(28),
+	KEY_CPAD_LEFT  = BIT(29),
+	KEY_CPAD_UP    = BIT(30),
+	KEY_CPAD_DOWN  = BIT(31),
+
+	KEY_UP    = KEY_DUP    | KEY_CPAD_UP,
+	KEY_DOWN  = KEY_DDOWN  | KEY_CPAD_DOWN,
+	KEY_LEFT  = KEY_DLEFT  | KEY_CPAD_LEFT,
+	KEY_RIGHT = KEY_DRIGHT | KEY_CPAD_RIGHT,
+};
+
+typedef struct {
+	u16 px;
+	u16 py;
+} touchPosition;
+
+void hidScanInput(void);
+u32 hidKeysDown(void);
+u32 hidKeysHeld(void);
+u32 hidKeysUp(void);
+void hidTouchRead(touchPosition* pos);
+
+//Host only. Sets the input state returned by the next hidScanInput().
+void hostSetInput(u32 held, touchPosition touch);
+
+//------------------------------------------------------------------------------------
+// GFX / Console / APT / OS
+
+typedef enum {
+	GFX_TOP = 0,
+	GFX_BOTTOM = 1
+} gfxScreen_t;
+
+typedef enum {
+	GFX_LEFT = 0,
+	GFX_RIGHT = 1
+} gfx3dSide_t;
+
+typedef struct {
+	int cursorX;
+	int cursorY;
+} PrintConsole;
+
+void gfxInitDefault(void);
+void gfxExit(void);
+void gfxSet3D(bool enable);
+PrintConsole* consoleInit(gfxScreen_t screen, PrintConsole* console);
+PrintConsole* consoleSelect(PrintConsole* console);
+bool aptMainLoop(void);
+float osGet3DSliderState(void);
+u64 svcGetSystemTick(void);
+
+//Host only. Sets the value returned by osGet3DSliderState(), so the stereo path can be benchmarked.
+void hostSet3DSlider(float value);
+
+//------------------------------------------------------------------------------------
+// RomFS. On the host there is nothing to mount, files are read from the romfs directory instead.
+
+Result romfsInit(void);
+Result romfsExit(void);
+
+//------------------------------------------------------------------------------------
+// Threads and synchronization. Backed by std::thread, and a mutex and condition variable. Core IDs are ignored.
+
+typedef struct Thread_tag* Thread;
+typedef void (*ThreadFunc)(void*);
+
+#define CUR_THREAD_HANDLE 0xFFFF8000
+
+Thread threadCreate(ThreadFunc entrypoint, void* arg, size_t stack_size, int prio, int core_id, bool detached);
+Result threadJoin(Thread thread, u64 timeout_ns);
+void threadFree(Thread thread);
+Result svcGetThreadPriority(s32* out, u32 handle);
+
+typedef s32 LightLock;
+
+void LightLock_Init(LightLock* lock);
+void LightLock_Lock(LightLock* lock);
+int LightLock_TryLock(LightLock* lock);
+void LightLock_Unlock(LightLock* lock);
+
+typedef enum {
+	RESET_ONESHOT = 0,
+	RESET_STICKY = 1,
+	RESET_PULSE = 2
+} ResetType;
+
+//State is -1 (clear) or 0 (signalled) for one shot events, -2 (clear) or 1 (signalled) for sticky ones, like libctru.
+typedef struct {
+	s32 state;
+	LightLock lock;
+} LightEvent;
+
+void LightEvent_Init(LightEvent* event, ResetType reset_type);
+void LightEvent_Clear(LightEvent* event);
+void LightEvent_Signal(LightEvent* event);
+void LightEvent_Wait(LightEvent* event);
+
+//------------------------------------------------------------------------------------
+// Linear memory
+
+void* linearAlloc(size_t size);
+void linearFree(void* mem);
+
+//------------------------------------------------------------------------------------
+// GX
+
+#define GX_TRANSFER_FLIP_VERT(x)  ((x)<<0)
+#define GX_TRANSFER_OUT_TILED(x)  ((x)<<1)
+#define GX_TRANSFER_RAW_COPY(x)   ((x)<<3)
+#define GX_TRANSFER_IN_FORMAT(x)  ((x)<<8)
+#define GX_TRANSFER_OUT_FORMAT(x) ((x)<<12)
+#define GX_TRANSFER_SCALING(x)    ((x)<<24)
+
+typedef enum {
+	GX_TRANSFER_FMT_RGBA8  = 0,
+	GX_TRANSFER_FMT_RGB8   = 1,
+	GX_TRANSFER_FMT_RGB565 = 2,
+	GX_TRANSFER_FMT_RGB5A1 = 3,
+	GX_TRANSFER_FMT_RGBA4  = 4
+} GX_TRANSFER_FORMAT;
+
+typedef enum {
+	GX_TRANSFER_SCALE_NO = 0,
+	GX_TRANSFER_SCALE_X  = 1,
+	GX_TRANSFER_SCALE_XY = 2
+} GX_TRANSFER_SCALE;
+
+//------------------------------------------------------------------------------------
+// GPU enums
+
+typedef enum {
+	GPU_VERTEX_SHADER = 0,
+	GPU_GEOMETRY_SHADER = 1
+} GPU_SHADER_TYPE;
+
+typedef enum {
+	GPU_BYTE = 0,
+	GPU_UNSIGNED_BYTE = 1,
+	GPU_SHORT = 2,
+	GPU_FLOAT = 3
+} GPU_FORMATS;
+
+typedef enum {
+	GPU_TRIANGLES = 0x0000,
+	GPU_TRIANGLE_STRIP = 0x0100,
+	GPU_TRIANGLE_FAN = 0x0200,
+	GPU_GEOMETRY_PRIM = 0x0300
+} GPU_Primitive_t;
+
+typedef enum {
+	GPU_RB_RGBA8 = 0,
+	GPU_RB_RGB8 = 1,
+	GPU_RB_RGBA5551 = 2,
+	GPU_RB_RGB565 = 3,
+	GPU_RB_RGBA4 = 4
+} GPU_COLORBUF;
+
+typedef enum {
+	GPU_RB_DEPTH16 = 0,
+	GPU_RB_DEPTH24 = 2,
+	GPU_RB_DEPTH24_STENCIL8 = 3
+} GPU_DEPTHBUF;
+
+typedef enum {
+	GPU_PRIMARY_COLOR = 0x00,
+	GPU_FRAGMENT_PRIMARY_COLOR = 0x01,
+	GPU_FRAGMENT_SECONDARY_COLOR = 0x02,
+	GPU_TEXTURE0 = 0x03,
+	GPU_CONSTANT = 0x0E,
+	GPU_PREVIOUS = 0x0F
+} GPU_TEVSRC;
+
+typedef enum {
+	GPU_REPLACE = 0x00,
+	GPU_MODULATE = 0x01,
+	GPU_ADD = 0x02
+} GPU_COMBINEFUNC;
+
+typedef enum {
+	GPU_LUT_D0 = 0,
+	GPU_LUT_D1 = 1
+} GPU_LIGHTLUTID;
+
+typedef enum {
+	GPU_LUTINPUT_NH = 0,
+	GPU_LUTINPUT_VH = 1,
+	GPU_LUTINPUT_NV = 2,
+	GPU_LUTINPUT_LN = 3
+} GPU_LIGHTLUTINPUT;
+
+//------------------------------------------------------------------------------------
+// Shaders
+
+typedef struct {
+	u32 type;
+} DVLE_s;
+
+typedef struct {
+	u32 numDVLE;
+	DVLE_s* DVLE;
+} DVLB_s;
+
+typedef struct {
+	DVLE_s* dvle;
+} shaderInstance_s;
+
+typedef struct {
+	shaderInstance_s* vertexShader;
+	shaderInstance_s* geometryShader;
+} shaderProgram_s;
+
+DVLB_s* DVLB_ParseFile(u32* shbinData, u32 shbinSize);
+void DVLB_Free(DVLB_s* dvlb);
+Result shaderProgramInit(shaderProgram_s* sp);
+Result shaderProgramFree(shaderProgram_s* sp);
+Result shaderProgramSetVsh(shaderProgram_s* sp, DVLE_s* dvle);
+s8 shaderInstanceGetUniformLocation(shaderInstance_s* si, const char* name);
+
+#endif
@@ -0,0 +1,292 @@
+#pragma once
+
+#ifndef HOST_CITRO3D_HEADER
+#	define HOST_CITRO3D_HEADER
+
+//Host stand-in for citro3d. The maths (C3D_FVec, C3D_Mtx, Mtx_*, FVec*, Quat_*) follow citro3d's
+//own definitions, including its reversed w/z/y/x storage order, so engine results match the device.
+//Everything that talks to the GPU only records counters, which the headless driver reports.
+
+#include "3ds.h"
+#include <math.h>
+
+typedef union {
+	struct { float w, z, y, x; };
+	struct { float r, k, j, i; };
+	float c[4];
+} C3D_FVec;
+
+typedef C3D_FVec C3D_FQuat;
+
+typedef union {
+	C3D_FVec r[4];
+	float m[4*4];
+} C3D_Mtx;
+
+//------------------------------------------------------------------------------------
+// Vectors
+
+static inline C3D_FVec FVec4_New(float x, float y, float z, float w){
+	C3D_FVec v = { { w, z, y, x } };
+	return v;
+}
+
+static inline C3D_FVec FVec4_Add(C3D_FVec lhs, C3D_FVec rhs){
+	return FVec4_New(lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z, lhs.w + rhs.w);
+}
+
+static inline C3D_FVec FVec4_Subtract(C3D_FVec lhs, C3D_FVec rhs){
+	return FVec4_New(lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z, lhs.w - rhs.w);
+}
+
+static inline C3D_FVec FVec4_Negate(C3D_FVec v){
+	return FVec4_New(-v.x, -v.y, -v.z, -v.w);
+}
+
+static inline C3D_FVec FVec4_Scale(C3D_FVec v, float s){
+	return FVec4_New(v.x * s, v.y * s, v.z * s, v.w * s);
+}
+
+static inline float FVec4_Dot(C3D_FVec lhs, C3D_FVec rhs){
+	return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z + lhs.w * rhs.w;
+}
+
+static inline float FVec4_Magnitude(C3D_FVec v){
+	return sqrtf(FVec4_Dot(v, v));
+}
+
+static inline C3D_FVec FVec4_Normalize(C3D_FVec v){
+	return FVec4_Scale(v, 1.0f / FVec4_Magnitude(v));
+}
+
+static inline C3D_FVec FVec3_New(float x, float y, float z){
+	return FVec4_New(x, y, z, 0.0f);
+}
+
+static inline float FVec3_Dot(C3D_FVec lhs, C3D_FVec rhs){
+	return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
+}
+
+static inline float FVec3_Magnitude(C3D_FVec v){
+	return sqrtf(FVec3_Dot(v, v));
+}
+
+static inline C3D_FVec FVec3_Normalize(C3D_FVec v){
+	float m = FVec3_Magnitude(v);
+	return FVec3_New(v.x / m, v.y / m, v.z / m);
+}
+
+static inline C3D_FVec FVec3_Add(C3D_FVec lhs, C3D_FVec rhs){
+	return FVec3_New(lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z);
+}
+
+static inline C3D_FVec FVec3_Subtract(C3D_FVec lhs, C3D_FVec rhs){
+	return FVec3_New(lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z);
+}
+
+static inline C3D_FVec FVec3_Scale(C3D_FVec v, float s){
+	return FVec3_New(v.x * s, v.y * s, v.z * s);
+}
+
+static inline C3D_FVec FVec3_Negate(C3D_FVec v){
+	return FVec3_New(-v.x, -v.y, -v.z);
+}
+
+static inline float FVec3_Distance(C3D_FVec lhs, C3D_FVec rhs){
+	return FVec3_Magnitude(FVec3_Subtract(lhs, rhs));
+}
+
+static inline C3D_FVec FVec3_Cross(C3D_FVec lhs, C3D_FVec rhs){
+	return FVec3_New(lhs.y * rhs.z - lhs.z * rhs.y, lhs.z * rhs.x - lhs.x * rhs.z, lhs.x * rhs.y - lhs.y * rhs.x);
+}
+
+//------------------------------------------------------------------------------------
+// Matrices
+
+static inline void Mtx_Zeros(C3D_Mtx* out){
+	for (int i = 0; i < 16; i++){
+		out->m[i] = 0.0f;
+	}
+}
+
+static inline void Mtx_Copy(C3D_Mtx* out, const C3D_Mtx* in){
+	*out = *in;
+}
+
+void Mtx_Identity(C3D_Mtx* out);
+void Mtx_Multiply(C3D_Mtx* out, const C3D_Mtx* a, const C3D_Mtx* b);
+float Mtx_Inverse(C3D_Mtx* out);
+C3D_FVec Mtx_MultiplyFVec4(const C3D_Mtx* mtx, C3D_FVec v);
+C3D_FVec Mtx_MultiplyFVec3(const C3D_Mtx* mtx, C3D_FVec v);
+void Mtx_Translate(C3D_Mtx* mtx, float x, float y, float z, bool bRightSide);
+void Mtx_Scale(C3D_Mtx* mtx, float x, float y, float z);
+void Mtx_RotateX(C3D_Mtx* mtx, float angle, bool bRightSide);
+void Mtx_RotateY(C3D_Mtx* mtx, float angle, bool bRightSide);
+void Mtx_RotateZ(C3D_Mtx* mtx, float angle, bool bRightSide);
+void Mtx_PerspTilt(C3D_Mtx* mtx, float fovx, float invaspect, float near, float far, bool isLeftHanded);
+void Mtx_PerspStereoTilt(C3D_Mtx* mtx, float fovx, float invaspect, float near, float far, float iod, float screen, bool isLeftHanded);
+void Mtx_FromQuat(C3D_Mtx* m, C3D_FQuat q);
+
+//------------------------------------------------------------------------------------
+// Quaternions
+
+static inline C3D_FQuat Quat_New(float i, float j, float k, float r){
+	return FVec4_New(i, j, k, r);
+}
+
+static inline C3D_FQuat Quat_Identity(void){
+	return Quat_New(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+static inline C3D_FQuat Quat_Conjugate(C3D_FQuat q){
+	return Quat_New(-q.i, -q.j, -q.k, q.r);
+}
+
+static inline float Quat_Dot(C3D_FQuat lhs, C3D_FQuat rhs){
+	return FVec4_Dot(lhs, rhs);
+}
+
+static inline C3D_FQuat Quat_Normalize(C3D_FQuat q){
+	return FVec4_Normalize(q);
+}
+
+C3D_FQuat Quat_Multiply(C3D_FQuat lhs, C3D_FQuat rhs);
+C3D_FVec Quat_CrossFVec3(C3D_FQuat q, C3D_FVec v);
+
+//------------------------------------------------------------------------------------
+// Renderer
+
+#define C3D_DEFAULT_CMDBUF_SIZE 0x40000
+
+enum {
+	C3D_FRAME_SYNCDRAW = BIT(0),
+	C3D_FRAME_NONBLOCK = BIT(1)
+};
+
+typedef enum {
+	C3D_CLEAR_COLOR = BIT(0),
+	C3D_CLEAR_DEPTH = BIT(1),
+	C3D_CLEAR_ALL   = C3D_CLEAR_COLOR | C3D_CLEAR_DEPTH
+} C3D_ClearBits;
+
+typedef enum {
+	C3D_RGB = BIT(0),
+	C3D_Alpha = BIT(1),
+	C3D_Both = C3D_RGB | C3D_Alpha
+} C3D_TexEnvMode;
+
+typedef struct {
+	u32 flags[2];
+	u64 permutation;
+	int attrCount;
+} C3D_AttrInfo;
+
+typedef struct {
+	u32 offset;
+	u32 flags[2];
+} C3D_BufCfg;
+
+typedef struct {
+	u32 base_paddr;
+	int bufCount;
+	C3D_BufCfg buffers[12];
+} C3D_BufInfo;
+
+typedef struct {
+	u16 srcRgb, srcAlpha;
+	u16 opRgb, opAlpha;
+	u16 funcRgb, funcAlpha;
+} C3D_TexEnv;
+
+typedef struct {
+	float ambient[3];
+	float diffuse[3];
+	float specular0[3];
+	float specular1[3];
+	float emission[3];
+} C3D_Material;
+
+typedef struct {
+	u32 data[256];
+} C3D_LightLut;
+
+typedef struct C3D_LightEnv_t C3D_LightEnv;
+
+typedef struct {
+	C3D_LightEnv* parent;
+	float color[3];
+	C3D_FVec position;
+} C3D_Light;
+
+struct C3D_LightEnv_t {
+	C3D_Material material;
+	C3D_LightLut* luts[2];
+};
+
+typedef struct {
+	int width, height;
+	int clearBits;
+	u32 clearColor;
+} C3D_RenderTarget;
+
+bool C3D_Init(size_t cmdBufSize);
+void C3D_Fini(void);
+void C3D_BindProgram(shaderProgram_s* program);
+
+C3D_AttrInfo* C3D_GetAttrInfo(void);
+void AttrInfo_Init(C3D_AttrInfo* info);
+int AttrInfo_AddLoader(C3D_AttrInfo* info, int regId, GPU_FORMATS format, int count);
+
+C3D_BufInfo* C3D_GetBufInfo(void);
+void BufInfo_Init(C3D_BufInfo* info);
+int BufInfo_Add(C3D_BufInfo* info, const void* data, ptrdiff_t stride, int attribCount, u64 permutation);
+
+C3D_TexEnv* C3D_GetTexEnv(int id);
+void C3D_TexEnvSrc(C3D_TexEnv* env, int mode, int s1, int s2, int s3);
+void C3D_TexEnvOp(C3D_TexEnv* env, int mode, int o1, int o2, int o3);
+void C3D_TexEnvFunc(C3D_TexEnv* env, int mode, int param);
+
+void C3D_LightEnvInit(C3D_LightEnv* env);
+void C3D_LightEnvBind(C3D_LightEnv* env);
+void C3D_LightEnvMaterial(C3D_LightEnv* env, const C3D_Material* mtl);
+void C3D_LightEnvLut(C3D_LightEnv* env, int lutId, int input, bool abs, C3D_LightLut* lut);
+void LightLut_Phong(C3D_LightLut* lut, float shininess);
+int C3D_LightInit(C3D_Light* light, C3D_LightEnv* env);
+void C3D_LightColor(C3D_Light* light, float r, float g, float b);
+void C3D_LightPosition(C3D_Light* light, C3D_FVec* pos);
+
+C3D_RenderTarget* C3D_RenderTargetCreate(int width, int height, int colorFmt, int depthFmt);
+void C3D_RenderTargetSetClear(C3D_RenderTarget* target, C3D_ClearBits clearBits, u32 clearColor, u32 clearDepth);
+void C3D_RenderTargetSetOutput(C3D_RenderTarget* target, gfxScreen_t screen, gfx3dSide_t side, u32 transferFlags);
+
+bool C3D_FrameBegin(u8 flags);
+bool C3D_FrameDrawOn(C3D_RenderTarget* target);
+void C3D_FrameEnd(u8 flags);
+
+//Milliseconds the GPU spent on the last frame's command list, and drawing it. There is no GPU here, so both are 0.
+float C3D_GetProcessingTime(void);
+float C3D_GetDrawingTime(void);
+
+void C3D_FVUnifMtx4x4(GPU_SHADER_TYPE type, int id, const C3D_Mtx* mtx);
+void C3D_DrawArrays(GPU_Primitive_t primitive, int first, int size);
+
+#define C3D_UNSIGNED_BYTE 0
+#define C3D_UNSIGNED_SHORT 1
+void C3D_DrawElements(GPU_Primitive_t primitive, int count, int type, const void* indices);
+
+//Host only. Work the renderer was asked to do, accumulated since the last reset.
+typedef struct {
+	u32 frames;
+	u32 targets;
+	u32 drawCalls;
+	u32 vertices;
+	u32 uniformUploads;
+	u32 bufferBinds;
+	//Vertices fetched times the stride of the last bound buffer, plus index bytes read.
+	u32 vertexBytes;
+} C3D_HostStats;
+
+const C3D_HostStats* C3D_HostGetStats(void);
+void C3D_HostResetStats(void);
+
+#endif
@@ -0,0 +1,4 @@
+//Host stand-in for the header picasso generates from vshader.v.pica. The shim never parses it.
+extern const u8 vshader_shbin_end[];
+extern const u8 vshader_shbin[];
+extern const u32 vshader_shbin_size;
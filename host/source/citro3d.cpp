@@ -0,0 +1,366 @@
+#include <citro3d.h>
+
+#include <cstring>
+
+//Host implementation of the citro3d subset declared in host/include/citro3d.h.
+//Matrix routines are written after citro3d's own, so results match what runs on hardware.
+
+namespace {
+	C3D_HostStats stats;
+	C3D_AttrInfo attrInfo;
+	C3D_BufInfo bufInfo;
+	C3D_TexEnv texEnv[6];
+	C3D_RenderTarget targets[4];
+	int targetCount = 0;
+	ptrdiff_t boundStride = 0;
+}
+
+//------------------------------------------------------------------------------------
+// Matrices
+
+void Mtx_Identity(C3D_Mtx* out){
+	Mtx_Zeros(out);
+	out->r[0].x = out->r[1].y = out->r[2].z = out->r[3].w = 1.0f;
+}
+
+void Mtx_Multiply(C3D_Mtx* out, const C3D_Mtx* a, const C3D_Mtx* b){
+	//If out is a or b, we need to avoid overwriting them while reading.
+	if (out == a || out == b){
+		C3D_Mtx temp;
+		Mtx_Multiply(&temp, a, b);
+		Mtx_Copy(out, &temp);
+		return;
+	}
+	for (int j = 0; j < 4; j++){
+		for (int i = 0; i < 4; i++){
+			out->r[j].c[i] = a->r[j].x * b->r[0].c[i] + a->r[j].y * b->r[1].c[i] + a->r[j].z * b->r[2].c[i] + a->r[j].w * b->r[3].c[i];
+		}
+	}
+}
+
+float Mtx_Inverse(C3D_Mtx* out){
+	//Cofactor expansion over the row-major elements, m[row * 4 + column] in x/y/z/w order.
+	float m[16];
+	for (int row = 0; row < 4; row++){
+		m[row * 4 + 0] = out->r[row].x;
+		m[row * 4 + 1] = out->r[row].y;
+		m[row * 4 + 2] = out->r[row].z;
+		m[row * 4 + 3] = out->r[row].w;
+	}
+
+	float inv[16];
+	inv[0] = m[5]*m[10]*m[15] - m[5]*m[11]*m[14] - m[9]*m[6]*m[15] + m[9]*m[7]*m[14] + m[13]*m[6]*m[11] - m[13]*m[7]*m[10];
+	inv[4] = -m[4]*m[10]*m[15] + m[4]*m[11]*m[14] + m[8]*m[6]*m[15] - m[8]*m[7]*m[14] - m[12]*m[6]*m[11] + m[12]*m[7]*m[10];
+	inv[8] = m[4]*m[9]*m[15] - m[4]*m[11]*m[13] - m[8]*m[5]*m[15] + m[8]*m[7]*m[13] + m[12]*m[5]*m[11] - m[12]*m[7]*m[9];
+	inv[12] = -m[4]*m[9]*m[14] + m[4]*m[10]*m[13] + m[8]*m[5]*m[14] - m[8]*m[6]*m[13] - m[12]*m[5]*m[10] + m[12]*m[6]*m[9];
+	inv[1] = -m[1]*m[10]*m[15] + m[1]*m[11]*m[14] + m[9]*m[2]*m[15] - m[9]*m[3]*m[14] - m[13]*m[2]*m[11] + m[13]*m[3]*m[10];
+	inv[5] = m[0]*m[10]*m[15] - m[0]*m[11]*m[14] - m[8]*m[2]*m[15] + m[8]*m[3]*m[14] + m[12]*m[2]*m[11] - m[12]*m[3]*m[10];
+	inv[9] = -m[0]*m[9]*m[15] + m[0]*m[11]*m[13] + m[8]*m[1]*m[15] - m[8]*m[3]*m[13] - m[12]*m[1]*m[11] + m[12]*m[3]*m[9];
+	inv[13] = m[0]*m[9]*m[14] - m[0]*m[10]*m[13] - m[8]*m[1]*m[14] + m[8]*m[2]*m[13] + m[12]*m[1]*m[10] - m[12]*m[2]*m[9];
+	inv[2] = m[1]*m[6]*m[15] - m[1]*m[7]*m[14] - m[5]*m[2]*m[15] + m[5]*m[3]*m[14] + m[13]*m[2]*m[7] - m[13]*m[3]*m[6];
+	inv[6] = -m[0]*m[6]*m[15] + m[0]*m[7]*m[14] + m[4]*m[2]*m[15] - m[4]*m[3]*m[14] - m[12]*m[2]*m[7] + m[12]*m[3]*m[6];
+	inv[10] = m[0]*m[5]*m[15] - m[0]*m[7]*m[13] - m[4]*m[1]*m[15] + m[4]*m[3]*m[13] + m[12]*m[1]*m[7] - m[12]*m[3]*m[5];
+	inv[14] = -m[0]*m[5]*m[14] + m[0]*m[6]*m[13] + m[4]*m[1]*m[14] - m[4]*m[2]*m[13] - m[12]*m[1]*m[6] + m[12]*m[2]*m[5];
+	inv[3] = -m[1]*m[6]*m[11] + m[1]*m[7]*m[10] + m[5]*m[2]*m[11] - m[5]*m[3]*m[10] - m[9]*m[2]*m[7] + m[9]*m[3]*m[6];
+	inv[7] = m[0]*m[6]*m[11] - m[0]*m[7]*m[10] - m[4]*m[2]*m[11] + m[4]*m[3]*m[10] + m[8]*m[2]*m[7] - m[8]*m[3]*m[6];
+	inv[11] = -m[0]*m[5]*m[11] + m[0]*m[7]*m[9] + m[4]*m[1]*m[11] - m[4]*m[3]*m[9] - m[8]*m[1]*m[7] + m[8]*m[3]*m[5];
+	inv[15] = m[0]*m[5]*m[10] - m[0]*m[6]*m[9] - m[4]*m[1]*m[10] + m[4]*m[2]*m[9] + m[8]*m[1]*m[6] - m[8]*m[2]*m[5];
+
+	float det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+	if (std::fabs(det) < 1e-20f){
+		return 0.0f;
+	}
+
+	float invDet = 1.0f / det;
+	for (int row = 0; row < 4; row++){
+		out->r[row].x = inv[row * 4 + 0] * invDet;
+		out->r[row].y = inv[row * 4 + 1] * invDet;
+		out->r[row].z = inv[row * 4 + 2] * invDet;
+		out->r[row].w = inv[row * 4 + 3] * invDet;
+	}
+	return det;
+}
+
+C3D_FVec Mtx_MultiplyFVec4(const C3D_Mtx* mtx, C3D_FVec v){
+	return FVec4_New(FVec4_Dot(mtx->r[0], v), FVec4_Dot(mtx->r[1], v), FVec4_Dot(mtx->r[2], v), FVec4_Dot(mtx->r[3], v));
+}
+
+C3D_FVec Mtx_MultiplyFVec3(const C3D_Mtx* mtx, C3D_FVec v){
+	return FVec3_New(FVec3_Dot(mtx->r[0], v), FVec3_Dot(mtx->r[1], v), FVec3_Dot(mtx->r[2], v));
+}
+
+void Mtx_Translate(C3D_Mtx* mtx, float x, float y, float z, bool bRightSide){
+	C3D_FVec v = FVec4_New(x, y, z, 1.0f);
+	if (bRightSide){
+		for (int i = 0; i < 4; i++){
+			mtx->r[i].w = FVec4_Dot(mtx->r[i], v);
+		}
+	}
+	else {
+		for (int j = 0; j < 3; j++){
+			for (int i = 0; i < 4; i++){
+				mtx->r[j].c[i] += mtx->r[3].c[i] * v.c[3 - j];
+			}
+		}
+	}
+}
+
+void Mtx_Scale(C3D_Mtx* mtx, float x, float y, float z){
+	for (int i = 0; i < 4; i++){
+		mtx->r[i].x *= x;
+		mtx->r[i].y *= y;
+		mtx->r[i].z *= z;
+	}
+}
+
+void Mtx_RotateX(C3D_Mtx* mtx, float angle, bool bRightSide){
+	C3D_Mtx rotation;
+	Mtx_Identity(&rotation);
+	float c = cosf(angle), s = sinf(angle);
+	rotation.r[1].y = c; rotation.r[1].z = -s;
+	rotation.r[2].y = s; rotation.r[2].z = c;
+	if (bRightSide){
+		Mtx_Multiply(mtx, mtx, &rotation);
+	}
+	else {
+		Mtx_Multiply(mtx, &rotation, mtx);
+	}
+}
+
+void Mtx_RotateY(C3D_Mtx* mtx, float angle, bool bRightSide){
+	C3D_Mtx rotation;
+	Mtx_Identity(&rotation);
+	float c = cosf(angle), s = sinf(angle);
+	rotation.r[0].x = c; rotation.r[0].z = s;
+	rotation.r[2].x = -s; rotation.r[2].z = c;
+	if (bRightSide){
+		Mtx_Multiply(mtx, mtx, &rotation);
+	}
+	else {
+		Mtx_Multiply(mtx, &rotation, mtx);
+	}
+}
+
+void Mtx_RotateZ(C3D_Mtx* mtx, float angle, bool bRightSide){
+	C3D_Mtx rotation;
+	Mtx_Identity(&rotation);
+	float c = cosf(angle), s = sinf(angle);
+	rotation.r[0].x = c; rotation.r[0].y = -s;
+	rotation.r[1].x = s; rotation.r[1].y = c;
+	if (bRightSide){
+		Mtx_Multiply(mtx, mtx, &rotation);
+	}
+	else {
+		Mtx_Multiply(mtx, &rotation, mtx);
+	}
+}
+
+void Mtx_PerspTilt(C3D_Mtx* mtx, float fovx, float invaspect, float near, float far, bool isLeftHanded){
+	Mtx_PerspStereoTilt(mtx, fovx, invaspect, near, far, 0.0f, 1.0f, isLeftHanded);
+}
+
+void Mtx_PerspStereoTilt(C3D_Mtx* mtx, float fovx, float invaspect, float near, float far, float iod, float screen, bool isLeftHanded){
+	//The 3DS screens are sideways, so the usual left/right eye separation becomes top/bottom separation.
+	float fovx_tan = tanf(fovx / 2.0f);
+	float fovx_tan_invaspect = fovx_tan * invaspect;
+	float shift = iod / (2.0f * screen);
+
+	Mtx_Zeros(mtx);
+	mtx->r[0].y = 1.0f / fovx_tan;
+	mtx->r[1].x = -1.0f / fovx_tan_invaspect;
+	mtx->r[1].z = -shift / fovx_tan_invaspect;
+	mtx->r[1].w = iod / 2.0f;
+	mtx->r[3].z = isLeftHanded ? 1.0f : -1.0f;
+	mtx->r[2].z = -mtx->r[3].z * near / (near - far);
+	mtx->r[2].w = near * far / (near - far);
+}
+
+void Mtx_FromQuat(C3D_Mtx* m, C3D_FQuat q){
+	float ii = q.i * q.i;
+	float ij = q.i * q.j;
+	float ik = q.i * q.k;
+	float jj = q.j * q.j;
+	float jk = q.j * q.k;
+	float kk = q.k * q.k;
+	float ri = q.r * q.i;
+	float rj = q.r * q.j;
+	float rk = q.r * q.k;
+
+	m->r[0].x = 1.0f - (2.0f * (jj + kk));
+	m->r[1].x = 2.0f * (ij + rk);
+	m->r[2].x = 2.0f * (ik - rj);
+	m->r[3].x = 0.0f;
+
+	m->r[0].y = 2.0f * (ij - rk);
+	m->r[1].y = 1.0f - (2.0f * (ii + kk));
+	m->r[2].y = 2.0f * (jk + ri);
+	m->r[3].y = 0.0f;
+
+	m->r[0].z = 2.0f * (ik + rj);
+	m->r[1].z = 2.0f * (jk - ri);
+	m->r[2].z = 1.0f - (2.0f * (ii + jj));
+	m->r[3].z = 0.0f;
+
+	m->r[0].w = 0.0f;
+	m->r[1].w = 0.0f;
+	m->r[2].w = 0.0f;
+	m->r[3].w = 1.0f;
+}
+
+//------------------------------------------------------------------------------------
+// Quaternions
+
+C3D_FQuat Quat_Multiply(C3D_FQuat lhs, C3D_FQuat rhs){
+	float i = lhs.r * rhs.i + lhs.i * rhs.r + lhs.j * rhs.k - lhs.k * rhs.j;
+	float j = lhs.r * rhs.j + lhs.j * rhs.r + lhs.k * rhs.i - lhs.i * rhs.k;
+	float k = lhs.r * rhs.k + lhs.k * rhs.r + lhs.i * rhs.j - lhs.j * rhs.i;
+	float r = lhs.r * rhs.r - lhs.i * rhs.i - lhs.j * rhs.j - lhs.k * rhs.k;
+	return Quat_New(i, j, k, r);
+}
+
+C3D_FVec Quat_CrossFVec3(C3D_FQuat q, C3D_FVec v){
+	//v' = q * v * conjugate(q)
+	C3D_FQuat result = Quat_Multiply(Quat_Multiply(q, Quat_New(v.x, v.y, v.z, 0.0f)), Quat_Conjugate(q));
+	return FVec3_New(result.i, result.j, result.k);
+}
+
+//------------------------------------------------------------------------------------
+// Renderer
+
+bool C3D_Init(size_t cmdBufSize){
+	std::memset(&stats, 0, sizeof(stats));
+	return true;
+}
+
+void C3D_Fini(void){ }
+
+void C3D_BindProgram(shaderProgram_s* program){ }
+
+C3D_AttrInfo* C3D_GetAttrInfo(void){
+	return &attrInfo;
+}
+
+void AttrInfo_Init(C3D_AttrInfo* info){
+	std::memset(info, 0, sizeof(*info));
+}
+
+int AttrInfo_AddLoader(C3D_AttrInfo* info, int regId, GPU_FORMATS format, int count){
+	return info->attrCount++;
+}
+
+C3D_BufInfo* C3D_GetBufInfo(void){
+	return &bufInfo;
+}
+
+void BufInfo_Init(C3D_BufInfo* info){
+	std::memset(info, 0, sizeof(*info));
+}
+
+int BufInfo_Add(C3D_BufInfo* info, const void* data, ptrdiff_t stride, int attribCount, u64 permutation){
+	if (info->bufCount >= 12){
+		return -1;
+	}
+	stats.bufferBinds++;
+	boundStride = stride;
+	return info->bufCount++;
+}
+
+C3D_TexEnv* C3D_GetTexEnv(int id){
+	return &texEnv[id];
+}
+
+void C3D_TexEnvSrc(C3D_TexEnv* env, int mode, int s1, int s2, int s3){ }
+
+void C3D_TexEnvOp(C3D_TexEnv* env, int mode, int o1, int o2, int o3){ }
+
+void C3D_TexEnvFunc(C3D_TexEnv* env, int mode, int param){ }
+
+void C3D_LightEnvInit(C3D_LightEnv* env){
+	std::memset(env, 0, sizeof(*env));
+}
+
+void C3D_LightEnvBind(C3D_LightEnv* env){ }
+
+void C3D_LightEnvMaterial(C3D_LightEnv* env, const C3D_Material* mtl){
+	env->material = *mtl;
+}
+
+void C3D_LightEnvLut(C3D_LightEnv* env, int lutId, int input, bool abs, C3D_LightLut* lut){
+	env->luts[lutId & 1] = lut;
+}
+
+void LightLut_Phong(C3D_LightLut* lut, float shininess){ }
+
+int C3D_LightInit(C3D_Light* light, C3D_LightEnv* env){
+	light->parent = env;
+	return 0;
+}
+
+void C3D_LightColor(C3D_Light* light, float r, float g, float b){
+	light->color[0] = r;
+	light->color[1] = g;
+	light->color[2] = b;
+}
+
+void C3D_LightPosition(C3D_Light* light, C3D_FVec* pos){
+	light->position = *pos;
+}
+
+C3D_RenderTarget* C3D_RenderTargetCreate(int width, int height, int colorFmt, int depthFmt){
+	C3D_RenderTarget* target = &targets[targetCount++ & 3];
+	target->width = width;
+	target->height = height;
+	return target;
+}
+
+void C3D_RenderTargetSetClear(C3D_RenderTarget* target, C3D_ClearBits clearBits, u32 clearColor, u32 clearDepth){
+	target->clearBits = clearBits;
+	target->clearColor = clearColor;
+}
+
+void C3D_RenderTargetSetOutput(C3D_RenderTarget* target, gfxScreen_t screen, gfx3dSide_t side, u32 transferFlags){ }
+
+bool C3D_FrameBegin(u8 flags){
+	return true;
+}
+
+bool C3D_FrameDrawOn(C3D_RenderTarget* target){
+	stats.targets++;
+	return true;
+}
+
+void C3D_FrameEnd(u8 flags){
+	stats.frames++;
+}
+
+float C3D_GetProcessingTime(void){
+	return 0.0f;
+}
+
+float C3D_GetDrawingTime(void){
+	return 0.0f;
+}
+
+void C3D_FVUnifMtx4x4(GPU_SHADER_TYPE type, int id, const C3D_Mtx* mtx){
+	stats.uniformUploads++;
+}
+
+void C3D_DrawArrays(GPU_Primitive_t primitive, int first, int size){
+	stats.drawCalls++;
+	stats.vertices += size;
+	stats.vertexBytes += size * boundStride;
+}
+
+void C3D_DrawElements(GPU_Primitive_t primitive, int count, int type, const void* indices){
+	stats.drawCalls++;
+	stats.vertices += count;
+	stats.vertexBytes += count * (boundStride + (type == C3D_UNSIGNED_SHORT ? 2 : 1));
+}
+
+const C3D_HostStats* C3D_HostGetStats(void){
+	return &stats;
+}
+
+void C3D_HostResetStats(void){
+	std::memset(&stats, 0, sizeof(stats));
+}
@@ -0,0 +1,234 @@
+#include <3ds.h>
+#include <vshader_shbin.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+//Host implementation of the libctru subset declared in host/include/3ds.h.
+
+namespace {
+	u32 keysHeld = 0;
+	u32 keysHeldPrevious = 0;
+	u32 keysHeldNext = 0;
+	touchPosition touchCurrent = { 0, 0 };
+	touchPosition touchNext = { 0, 0 };
+	float sliderState = 0.0f;
+
+	DVLE_s hostDVLE = { 0 };
+	DVLB_s hostDVLB = { 1, &hostDVLE };
+	shaderInstance_s hostVertexShader = { &hostDVLE };
+}
+
+const u8 vshader_shbin[4] = { 0 };
+const u8 vshader_shbin_end[1] = { 0 };
+const u32 vshader_shbin_size = sizeof(vshader_shbin);
+
+void hostSetInput(u32 held, touchPosition touch){
+	keysHeldNext = held;
+	touchNext = touch;
+}
+
+void hidScanInput(void){
+	keysHeldPrevious = keysHeld;
+	keysHeld = keysHeldNext;
+	touchCurrent = touchNext;
+}
+
+u32 hidKeysDown(void){
+	return keysHeld & ~keysHeldPrevious;
+}
+
+u32 hidKeysHeld(void){
+	return keysHeld;
+}
+
+u32 hidKeysUp(void){
+	return keysHeldPrevious & ~keysHeld;
+}
+
+void hidTouchRead(touchPosition* pos){
+	*pos = touchCurrent;
+}
+
+void gfxInitDefault(void){ }
+
+void gfxExit(void){ }
+
+void gfxSet3D(bool enable){ }
+
+PrintConsole* consoleInit(gfxScreen_t screen, PrintConsole* console){
+	console->cursorX = console->cursorY = 0;
+	return console;
+}
+
+PrintConsole* consoleSelect(PrintConsole* console){
+	return console;
+}
+
+bool aptMainLoop(void){
+	return true;
+}
+
+Result romfsInit(void){
+	return 0;
+}
+
+Result romfsExit(void){
+	return 0;
+}
+
+void hostSet3DSlider(float value){
+	sliderState = value;
+}
+
+float osGet3DSliderState(void){
+	return sliderState;
+}
+
+u64 svcGetSystemTick(void){
+	//Scale the host monotonic clock to ARM11 ticks, so tick arithmetic in the engine stays the same.
+	static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+	return (u64) ((double) elapsed.count() * (SYSCLOCK_ARM11 / 1e9));
+}
+
+struct Thread_tag {
+	std::thread thread;
+};
+
+namespace {
+	//Every LightEvent shares one condition variable. Waiters recheck their own event's state when woken.
+	std::mutex eventMutex;
+	std::condition_variable eventChanged;
+}
+
+Thread threadCreate(ThreadFunc entrypoint, void* arg, size_t stack_size, int prio, int core_id, bool detached){
+	Thread thread = new Thread_tag;
+	thread->thread = std::thread(entrypoint, arg);
+	if (detached){
+		thread->thread.detach();
+	}
+	return thread;
+}
+
+Result threadJoin(Thread thread, u64 timeout_ns){
+	if (thread->thread.joinable()){
+		thread->thread.join();
+	}
+	return 0;
+}
+
+void threadFree(Thread thread){
+	if (thread->thread.joinable()){
+		thread->thread.detach();
+	}
+	delete thread;
+}
+
+Result svcGetThreadPriority(s32* out, u32 handle){
+	*out = 0x30;
+	return 0;
+}
+
+void LightLock_Init(LightLock* lock){
+	__atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+}
+
+void LightLock_Lock(LightLock* lock){
+	while (!LightLock_TryLock(lock)){
+		std::this_thread::yield();
+	}
+}
+
+int LightLock_TryLock(LightLock* lock){
+	s32 expected = 0;
+	return __atomic_compare_exchange_n(lock, &expected, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED) ? 1 : 0;
+}
+
+void LightLock_Unlock(LightLock* lock){
+	__atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+}
+
+void LightEvent_Init(LightEvent* event, ResetType reset_type){
+	std::lock_guard<std::mutex> guard(eventMutex);
+	event->state = reset_type == RESET_STICKY ? -2 : -1;
+	LightLock_Init(&event->lock);
+}
+
+void LightEvent_Clear(LightEvent* event){
+	std::lock_guard<std::mutex> guard(eventMutex);
+	if (event->state == 1){
+		event->state = -2;
+	}
+	else if (event->state == 0){
+		event->state = -1;
+	}
+}
+
+void LightEvent_Signal(LightEvent* event){
+	std::lock_guard<std::mutex> guard(eventMutex);
+	if (event->state == -2){
+		event->state = 1;
+		eventChanged.notify_all();
+	}
+	else if (event->state == -1){
+		event->state = 0;
+		eventChanged.notify_all();
+	}
+}
+
+void LightEvent_Wait(LightEvent* event){
+	std::unique_lock<std::mutex> guard(eventMutex);
+	eventChanged.wait(guard, [event]{ return event->state >= 0; });
+	if (event->state == 0){
+		event->state = -1;
+	}
+}
+
+void* linearAlloc(size_t size){
+	//Linear heap allocations are 0x80 aligned on hardware.
+	void* result = nullptr;
+	if (posix_memalign(&result, 0x80, size) != 0){
+		return nullptr;
+	}
+	return result;
+}
+
+void linearFree(void* mem){
+	std::free(mem);
+}
+
+DVLB_s* DVLB_ParseFile(u32* shbinData, u32 shbinSize){
+	return &hostDVLB;
+}
+
+void DVLB_Free(DVLB_s* dvlb){ }
+
+Result shaderProgramInit(shaderProgram_s* sp){
+	sp->vertexShader = nullptr;
+	sp->geometryShader = nullptr;
+	return 0;
+}
+
+Result shaderProgramFree(shaderProgram_s* sp){
+	sp->vertexShader = nullptr;
+	return 0;
+}
+
+Result shaderProgramSetVsh(shaderProgram_s* sp, DVLE_s* dvle){
+	sp->vertexShader = &hostVertexShader;
+	return 0;
+}
+
+s8 shaderInstanceGetUniformLocation(shaderInstance_s* si, const char* name){
+	//Uniform registers as laid out by vshader.v.pica: projection[4], model[4], view[4].
+	switch (name[0]){
+		case 'p': return 0;
+		case 'm': return 4;
+		case 'v': return 8;
+		default: return -1;
+	}
+}
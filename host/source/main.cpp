@@ -0,0 +1,316 @@
+#include "../../source/main.h"
+
+#include <chrono>
+#include <cstdio>
+#include <streambuf>
+
+//Headless host driver. Runs Engine::Core for a fixed number of frames with scripted input, without
+//hardware or Citra, and reports where the time went. Usage:
+//
+//    <target>-host [--frames N] [--objects N] [--stack N] [--lod SIZE] [--fps N] [--physics-hz N] [--stereo]
+//                  [--profile FILE] [--record FILE | --replay FILE] [--load-scene FILE] [--save-scene FILE]
+//                  [--workers N] [--verbose]
+//
+//--objects spawns N extra cubes in a grid on top of the ones Core::LoadObjects() creates. --stack piles them up in
+//towers of N cubes resting on each other instead, for timing the collision broadphase and solver.
+//--lod gives the spawned cubes a second detail level, drawn once a cube is smaller than SIZE of the screen height.
+//There is no coarser cube, so the built-in vertex list stands in for it. It is a mesh of its own next to
+//romfs/cube.mesh, so this exercises the switching and the extra buffer binds, but not the vertex savings.
+//--fps sets the simulated frame rate (default 60). Every frame advances the game clock by exactly 1/fps seconds,
+//so runs are repeatable no matter how fast the host is. --physics-hz sets the fixed physics rate (default 60).
+//--stereo pushes the 3D slider all the way up, so SubmitEye() runs for both eyes.
+//--profile writes the frame profiler's history (the last Profiler::HistoryFrames frames) to FILE as CSV.
+//--workers sets the number of job system worker threads. Defaults to one per spare core, up to JobSystem::MaxWorkers.
+//--workers 1 is what a New 3DS runs with, --workers 0 an Old 3DS.
+//--record writes the input of every frame to FILE, see Engine::InputLog. --replay plays such a log back instead of the
+//scripted input, with its frame times and 3D slider, until it runs out or --frames is reached. Logs recorded on a
+//3DS replay here too, so device sessions can be profiled on the host.
+//--load-scene replaces the objects Core::LoadObjects() created with the ones in a scene file, before spawning any others,
+//and --save-scene writes the world as it is after the last frame to one, see Engine::Core::SaveScene(). Saving after
+//--frames 0 snapshots the starting state, and loading it again restores it.
+//--verbose keeps the engine's console output, which is discarded by default.
+
+namespace {
+	//Swallows everything the engine writes to std::cout, so console output does not skew timings.
+	class NullBuffer : public std::streambuf {
+	protected:
+		int overflow(int c) override {
+			return c;
+		}
+	};
+
+	typedef std::chrono::steady_clock Clock;
+
+	double ElapsedMicroseconds(Clock::time_point start, Clock::time_point end){
+		return std::chrono::duration<double, std::micro>(end - start).count();
+	}
+
+	//Walk forward, look around with the touchscreen, then hold Y to pick up objects. Repeats every 240 frames.
+	u32 ScriptedInput(u32 frame, touchPosition& touch){
+		u32 phase = frame % 240;
+		touch.px = touch.py = 0;
+		if (phase < 60){
+			return KEY_UP;
+		}
+		if (phase < 120){
+			touch.px = (u16) (160 + (phase - 60));
+			touch.py = 120;
+			return KEY_TOUCH;
+		}
+		if (phase < 200){
+			return KEY_Y | (phase < 160 ? KEY_LEFT : 0);
+		}
+		return KEY_DOWN | KEY_A;
+	}
+
+	//FNV-1a over every transform's position and rotation. Two runs of the same input log end on the same hash.
+	u32 HashTransforms(){
+		const TransformPool& transforms = ComponentPools::Instance().transforms;
+		u32 hash = 2166136261u;
+		for (size_t i = 0; i < transforms.position.size(); i++){
+			const u8* bytes[2] = { (const u8*) &transforms.position[i], (const u8*) &transforms.rotation[i] };
+			for (u32 part = 0; part < 2; part++){
+				for (u32 b = 0; b < sizeof(C3D_FVec); b++){
+					hash = (hash ^ bytes[part][b]) * 16777619u;
+				}
+			}
+		}
+		return hash;
+	}
+
+	void SpawnObjects(Engine::Core& core, u32 count, u32 stack, float detailSize){
+		u32 towers = stack > 0 ? (count + stack - 1) / stack : count;
+		u32 side = 1;
+		while (side * side < towers){
+			side++;
+		}
+		//Every spawned cube draws the same mesh, so creating one is just taking another reference to it.
+		Handle mesh = MeshRegistry::Instance().Load("cube.mesh");
+		if (mesh == InvalidHandle){
+			mesh = MeshRegistry::Instance().Acquire(vertexList, vertexListSize);
+		}
+		if (detailSize > 0.0f){
+			Handle coarse = MeshRegistry::Instance().Acquire(vertexList, vertexListSize);
+			MeshRegistry::Instance().AddDetailLevel(mesh, coarse, detailSize);
+			MeshRegistry::Instance().Release(coarse);
+		}
+		for (u32 i = 0; i < count; i++){
+			GameObject* temp = core.GetGameObject(core.CreateObject(mesh));
+			PhysicsComponent p;
+			temp->AddComponent<PhysicsComponent>(p);
+			TransformComponent t;
+			temp->AddComponent<TransformComponent>(t);
+			if (stack > 0){
+				//Towers 1.5 apart, of unit cubes exactly one on top of the other.
+				u32 tower = i / stack;
+				temp->Position().x = 1.5f * (float) (tower % side) - (float) side;
+				temp->Position().y = (float) (i % stack);
+				temp->Position().z = -1.5f * (float) (tower / side);
+			}
+			else {
+				temp->Position().x = 2.0f * (float) (i % side) - (float) side;
+				temp->Position().y = 1.0f + (float) (i % 7);
+				temp->Position().z = -2.0f * (float) (i / side);
+			}
+		}
+		MeshRegistry::Instance().Release(mesh);
+	}
+}
+
+int main(int argc, char** argv){
+	u32 frames = 600;
+	u32 objects = 0;
+	u32 stack = 0;
+	float detailSize = 0.0f;
+	float fps = 60.0f;
+	float physicsRate = 60.0f;
+	bool stereo = false;
+	bool verbose = false;
+	const char* profilePath = nullptr;
+	const char* recordPath = nullptr;
+	const char* replayPath = nullptr;
+	const char* loadScenePath = nullptr;
+	const char* saveScenePath = nullptr;
+	bool framesGiven = false;
+	s32 workers = -1;
+	for (int i = 1; i < argc; i++){
+		if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc){
+			frames = (u32) std::strtoul(argv[++i], nullptr, 10);
+			framesGiven = true;
+		}
+		else if (std::strcmp(argv[i], "--objects") == 0 && i + 1 < argc){
+			objects = (u32) std::strtoul(argv[++i], nullptr, 10);
+		}
+		else if (std::strcmp(argv[i], "--stack") == 0 && i + 1 < argc){
+			stack = (u32) std::strtoul(argv[++i], nullptr, 10);
+		}
+		else if (std::strcmp(argv[i], "--lod") == 0 && i + 1 < argc){
+			detailSize = (float) std::atof(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc){
+			fps = (float) std::atof(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--physics-hz") == 0 && i + 1 < argc){
+			physicsRate = (float) std::atof(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--stereo") == 0){
+			stereo = true;
+		}
+		else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc){
+			profilePath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc){
+			recordPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc){
+			replayPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--load-scene") == 0 && i + 1 < argc){
+			loadScenePath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--save-scene") == 0 && i + 1 < argc){
+			saveScenePath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc){
+			workers = (s32) std::strtol(argv[++i], nullptr, 10);
+		}
+		else if (std::strcmp(argv[i], "--verbose") == 0){
+			verbose = true;
+		}
+		else {
+			std::fprintf(stderr, "Usage: %s [--frames N] [--objects N] [--stack N] [--lod SIZE] [--fps N] [--physics-hz N] [--stereo] [--profile FILE] [--record FILE | --replay FILE] [--load-scene FILE] [--save-scene FILE] [--workers N] [--verbose]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (fps <= 0.0f || physicsRate <= 0.0f){
+		std::fprintf(stderr, "--fps and --physics-hz must be positive.\n");
+		return 1;
+	}
+
+	Engine::InputLog inputLog;
+	if (replayPath){
+		if (!inputLog.StartReplay(replayPath)){
+			std::fprintf(stderr, "Cannot replay %s.\n", replayPath);
+			return 1;
+		}
+		if (!framesGiven || inputLog.Length() < frames){
+			frames = inputLog.Length();
+		}
+	}
+	else if (recordPath && !inputLog.StartRecording(recordPath)){
+		std::fprintf(stderr, "Cannot record to %s.\n", recordPath);
+		return 1;
+	}
+
+	NullBuffer nullBuffer;
+	std::streambuf* consoleBuffer = std::cout.rdbuf();
+	if (!verbose){
+		std::cout.rdbuf(&nullBuffer);
+	}
+
+	gfxInitDefault();
+	romfsInit();
+	PrintConsole output;
+	consoleSelect(consoleInit(GFX_BOTTOM, &output));
+	hostSet3DSlider(stereo ? 1.0f : 0.0f);
+
+	Engine::Core& core = Engine::Core::Instance();
+	double sceneLoadTime = 0.0;
+	core.Initialize();
+	core.SetPhysicsRate(physicsRate, 4);
+	if (workers >= 0){
+		Engine::JobSystem::Instance().Initialize((u32) workers);
+	}
+	if (loadScenePath){
+		Clock::time_point start = Clock::now();
+		if (!core.LoadScene(loadScenePath)){
+			std::cout.rdbuf(consoleBuffer);
+			std::fprintf(stderr, "Cannot load scene %s.\n", loadScenePath);
+			return 1;
+		}
+		sceneLoadTime = ElapsedMicroseconds(start, Clock::now());
+	}
+	SpawnObjects(core, objects, stack, detailSize);
+	core.SyncTransforms();
+	C3D_HostResetStats();
+
+	double updateTime = 0.0, renderTime = 0.0, worstFrame = 0.0;
+	double drawnObjects = 0.0, culledObjects = 0.0, reducedObjects = 0.0;
+	Engine::InputState input;
+
+	for (u32 frame = 0; frame < frames && aptMainLoop(); frame++){
+		touchPosition script;
+		hostSetInput(ScriptedInput(frame, script), script);
+
+		hidScanInput();
+		input.down = hidKeysDown();
+		input.held = hidKeysHeld();
+		input.up = hidKeysUp();
+		hidTouchRead(&input.touch);
+		input.deltaTime = 1.0f / fps;
+		input.slider = osGet3DSliderState();
+		inputLog.Process(input);
+
+		Clock::time_point start = Clock::now();
+		core.Update(input.down, input.held, input.up, input.touch, input.deltaTime);
+		Clock::time_point middle = Clock::now();
+		core.Render(input.slider);
+		Clock::time_point end = Clock::now();
+
+		updateTime += ElapsedMicroseconds(start, middle);
+		renderTime += ElapsedMicroseconds(middle, end);
+		worstFrame = std::max(worstFrame, ElapsedMicroseconds(start, end));
+		drawnObjects += core.drawnObjects;
+		culledObjects += core.culledObjects;
+		reducedObjects += core.reducedObjects;
+	}
+
+	std::cout.rdbuf(consoleBuffer);
+
+	const C3D_HostStats* stats = C3D_HostGetStats();
+	double frameCount = frames > 0 ? (double) frames : 1.0;
+	std::printf("frames            %u\n", frames);
+	std::printf("game objects      %u\n", (u32) core.gameObjects.size());
+	std::printf("meshes            %u (%u bytes)\n", MeshRegistry::Instance().Count(), MeshRegistry::Instance().LinearMemoryUsed());
+	const LinearMemoryStats& linear = LinearAllocator::Instance().Stats();
+	std::printf("linear reserved   %u bytes in %u allocations\n", linear.reservedBytes, linear.systemAllocations);
+	std::printf("linear used/peak  %u / %u bytes\n", linear.usedBytes, linear.usedHighWater);
+	std::printf("frame arena peak  %u bytes (%u overflows)\n", linear.frameHighWater, linear.frameOverflows);
+	std::printf("job workers       %u\n", Engine::JobSystem::Instance().WorkerCount());
+	std::printf("stereo            %s\n", replayPath ? "from input log" : (stereo ? "on" : "off"));
+	std::printf("fps / physics hz  %.1f / %.1f\n", fps, physicsRate);
+	std::printf("update avg (us)   %.2f\n", updateTime / frameCount);
+	std::printf("render avg (us)   %.2f\n", renderTime / frameCount);
+	std::printf("frame worst (us)  %.2f\n", worstFrame);
+	std::printf("drawn/culled      %.1f / %.1f\n", drawnObjects / frameCount, culledObjects / frameCount);
+	std::printf("reduced detail    %.1f\n", reducedObjects / frameCount);
+	std::printf("draw calls/frame  %.1f\n", stats->drawCalls / frameCount);
+	std::printf("vertices/frame    %.1f\n", stats->vertices / frameCount);
+	std::printf("vertex bytes/frame %.1f\n", stats->vertexBytes / frameCount);
+	std::printf("uniforms/frame    %.1f\n", stats->uniformUploads / frameCount);
+	std::printf("buffer binds/frame %.1f\n", stats->bufferBinds / frameCount);
+	std::printf("collision pairs   %u (%u touching)\n", core.collisions.PairCount(), core.collisions.ContactCount());
+	std::printf("sleeping bodies   %u / %u\n", ComponentPools::Instance().physics.SleepingCount(), ComponentPools::Instance().physics.Size());
+	std::printf("state hash        %08x\n", HashTransforms());
+	if (loadScenePath){
+		std::printf("scene load (us)   %.2f\n", sceneLoadTime);
+	}
+	std::fflush(stdout);
+
+	if (profilePath && !Engine::Profiler::Instance().Dump(profilePath)){
+		std::fprintf(stderr, "Cannot write %s.\n", profilePath);
+	}
+	if (saveScenePath && !core.SaveScene(saveScenePath)){
+		std::fprintf(stderr, "Cannot write %s.\n", saveScenePath);
+	}
+
+	if (!verbose){
+		std::cout.rdbuf(&nullBuffer);
+	}
+	inputLog.Stop();
+	core.Release();
+	romfsExit();
+	gfxExit();
+	std::cout.rdbuf(consoleBuffer);
+	return 0;
+}
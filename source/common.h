@@ -7,86 +7,46 @@
 #include <citro3d.h>
 #include <float.h>
 
+#include <algorithm>
+#include <cerrno>
 #include <cstdlib>
 #include <cmath>
+#include <cstdio>
 #include <cstring>
 #include <iostream>
 #include <iomanip>
 #include <limits>
+#include <map>
 #include <memory>
+#include <sstream>
+#include <string>
 #include <typeinfo>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "fastmath.h"
+
 typedef struct {
 	float positions[3];
 	float texcoords[2];
 	float normals[3];
 } Vertex;
 
-static const Vertex vertexList[] =
-{
-	// First face (PZ)
-	// First triangle
-	{ { -0.5f, -0.5f, +0.5f },{ 0.0f, 0.0f },{ 0.0f, 0.0f, +1.0f } },
-	{ { +0.5f, -0.5f, +0.5f },{ 1.0f, 0.0f },{ 0.0f, 0.0f, +1.0f } },
-	{ { +0.5f, +0.5f, +0.5f },{ 1.0f, 1.0f },{ 0.0f, 0.0f, +1.0f } },
-	// Second triangle
-	{ { +0.5f, +0.5f, +0.5f },{ 1.0f, 1.0f },{ 0.0f, 0.0f, +1.0f } },
-	{ { -0.5f, +0.5f, +0.5f },{ 0.0f, 1.0f },{ 0.0f, 0.0f, +1.0f } },
-	{ { -0.5f, -0.5f, +0.5f },{ 0.0f, 0.0f },{ 0.0f, 0.0f, +1.0f } },
-
-	// Second face (MZ)
-	// First triangle
-	{ { -0.5f, -0.5f, -0.5f },{ 0.0f, 0.0f },{ 0.0f, 0.0f, -1.0f } },
-	{ { -0.5f, +0.5f, -0.5f },{ 1.0f, 0.0f },{ 0.0f, 0.0f, -1.0f } },
-	{ { +0.5f, +0.5f, -0.5f },{ 1.0f, 1.0f },{ 0.0f, 0.0f, -1.0f } },
-	// Second triangle
-	{ { +0.5f, +0.5f, -0.5f },{ 1.0f, 1.0f },{ 0.0f, 0.0f, -1.0f } },
-	{ { +0.5f, -0.5f, -0.5f },{ 0.0f, 1.0f },{ 0.0f, 0.0f, -1.0f } },
-	{ { -0.5f, -0.5f, -0.5f },{ 0.0f, 0.0f },{ 0.0f, 0.0f, -1.0f } },
-
-	// Third face (PX)
-	// First triangle
-	{ { +0.5f, -0.5f, -0.5f },{ 0.0f, 0.0f },{ +1.0f, 0.0f, 0.0f } },
-	{ { +0.5f, +0.5f, -0.5f },{ 1.0f, 0.0f },{ +1.0f, 0.0f, 0.0f } },
-	{ { +0.5f, +0.5f, +0.5f },{ 1.0f, 1.0f },{ +1.0f, 0.0f, 0.0f } },
-	// Second triangle
-	{ { +0.5f, +0.5f, +0.5f },{ 1.0f, 1.0f },{ +1.0f, 0.0f, 0.0f } },
-	{ { +0.5f, -0.5f, +0.5f },{ 0.0f, 1.0f },{ +1.0f, 0.0f, 0.0f } },
-	{ { +0.5f, -0.5f, -0.5f },{ 0.0f, 0.0f },{ +1.0f, 0.0f, 0.0f } },
-
-	// Fourth face (MX)
-	// First triangle
-	{ { -0.5f, -0.5f, -0.5f },{ 0.0f, 0.0f },{ -1.0f, 0.0f, 0.0f } },
-	{ { -0.5f, -0.5f, +0.5f },{ 1.0f, 0.0f },{ -1.0f, 0.0f, 0.0f } },
-	{ { -0.5f, +0.5f, +0.5f },{ 1.0f, 1.0f },{ -1.0f, 0.0f, 0.0f } },
-	// Second triangle
-	{ { -0.5f, +0.5f, +0.5f },{ 1.0f, 1.0f },{ -1.0f, 0.0f, 0.0f } },
-	{ { -0.5f, +0.5f, -0.5f },{ 0.0f, 1.0f },{ -1.0f, 0.0f, 0.0f } },
-	{ { -0.5f, -0.5f, -0.5f },{ 0.0f, 0.0f },{ -1.0f, 0.0f, 0.0f } },
-
-	// Fifth face (PY)
-	// First triangle
-	{ { -0.5f, +0.5f, -0.5f },{ 0.0f, 0.0f },{ 0.0f, +1.0f, 0.0f } },
-	{ { -0.5f, +0.5f, +0.5f },{ 1.0f, 0.0f },{ 0.0f, +1.0f, 0.0f } },
-	{ { +0.5f, +0.5f, +0.5f },{ 1.0f, 1.0f },{ 0.0f, +1.0f, 0.0f } },
-	// Second triangle
-	{ { +0.5f, +0.5f, +0.5f },{ 1.0f, 1.0f },{ 0.0f, +1.0f, 0.0f } },
-	{ { +0.5f, +0.5f, -0.5f },{ 0.0f, 1.0f },{ 0.0f, +1.0f, 0.0f } },
-	{ { -0.5f, +0.5f, -0.5f },{ 0.0f, 0.0f },{ 0.0f, +1.0f, 0.0f } },
-
-	// Sixth face (MY)
-	// First triangle
-	{ { -0.5f, -0.5f, -0.5f },{ 0.0f, 0.0f },{ 0.0f, -1.0f, 0.0f } },
-	{ { +0.5f, -0.5f, -0.5f },{ 1.0f, 0.0f },{ 0.0f, -1.0f, 0.0f } },
-	{ { +0.5f, -0.5f, +0.5f },{ 1.0f, 1.0f },{ 0.0f, -1.0f, 0.0f } },
-	// Second triangle
-	{ { +0.5f, -0.5f, +0.5f },{ 1.0f, 1.0f },{ 0.0f, -1.0f, 0.0f } },
-	{ { -0.5f, -0.5f, +0.5f },{ 0.0f, 1.0f },{ 0.0f, -1.0f, 0.0f } },
-	{ { -0.5f, -0.5f, -0.5f },{ 0.0f, 0.0f },{ 0.0f, -1.0f, 0.0f } },
-};
+//What meshes are actually stored as on the GPU, 14 bytes instead of 32. Positions are integers the model matrix scales
+//back down (see Mesh::positionScale), texture coordinates are in 1/4096ths (the vertex shader scales them), and
+//normals are -127 to 127 (the vertex shader normalizes them). Attribute layout is set up in Core::Initialize().
+typedef struct {
+	s16 positions[3];
+	s16 texcoords[2];
+	s8 normals[3];
+	s8 padding;
+} PackedVertex;
+
+//Built in unit cube, as a plain triangle list. Defined in common.cpp, so there is one copy instead of one per source file.
+//Real meshes come from romfs, see MeshRegistry::Load().
+extern const Vertex vertexList[];
+extern const int vertexListSize;
 
 static const C3D_Material material =
 {
@@ -97,57 +57,61 @@ static const C3D_Material material =
 	{ 0.0f, 0.0f, 0.0f }, //emission
 };
 
-static const int vertexListSize = (sizeof(vertexList) / sizeof(vertexList[0]));
-static const float radian = std::acos(-1) / 180.0f;
+static constexpr float radian = FastMath::Pi / 180.0f;
 static const u32 COMMON_CLEAR_COLOR = 0x68B0D8FF;
 static const u32 COMMON_DISPLAY_TRANSFER_FLAGS = \
 	(GX_TRANSFER_FLIP_VERT(0) | GX_TRANSFER_OUT_TILED(0) | GX_TRANSFER_RAW_COPY(0) | \
 	GX_TRANSFER_IN_FORMAT(GX_TRANSFER_FMT_RGBA8) | GX_TRANSFER_OUT_FORMAT(GX_TRANSFER_FMT_RGB8) | \
 	GX_TRANSFER_SCALING(GX_TRANSFER_SCALE_NO));
 
-static inline float degToRad(float degrees){
+static constexpr float degToRad(float degrees){
 	return degrees * radian;
 }
 
-static inline std::string text(int row, int column, std::string message, u16 color = 37) {
-	std::stringstream ss;
-	ss << "\x1b[" << row << ";" << column << "H";
-	ss << "\x1b[" << color << "m";
-	ss << message;
-	ss << "\x1b[" << 37 << "m";
-	std::cout << ss.str() << std::endl;
-	return ss.str();
+static inline C3D_FQuat Quat_MyFromAxisAngle(C3D_FVec axis, float angle){
+	float sine, cosine;
+	FastMath::SinCos(angle / 2.0f, sine, cosine);
+	return FVec4_New(axis.x * sine, axis.y * sine, axis.z * sine, cosine);
 }
 
-static inline C3D_FQuat Quat_MyFromAxisAngle(C3D_FVec axis, float angle){
-	float halfAngle = angle / 2.0f;
-	float scale = std::sin(halfAngle);
-	return FVec4_New(axis.x * scale, axis.y * scale, axis.z * scale, std::cos(halfAngle));
+//Shortest rotation turning the unit vector from onto the unit vector to. The quaternion (from x to, 1 + from . to) is
+//that rotation at twice the length, since cross and dot are the sine and cosine of the full angle, and normalizing
+//halves the angle, so there is no need for the angle itself. Opposite vectors turn half way around any perpendicular axis.
+static inline C3D_FQuat Quat_MyFromVectors(C3D_FVec from, C3D_FVec to){
+	float w = 1.0f + FVec3_Dot(from, to);
+	if (w < 1e-6f){
+		C3D_FVec axis = std::abs(from.x) > std::abs(from.z) ? FVec3_New(-from.y, from.x, 0.0f) : FVec3_New(0.0f, -from.z, from.y);
+		axis = FVec3_Normalize(axis);
+		return Quat_New(axis.x, axis.y, axis.z, 0.0f);
+	}
+	C3D_FVec axis = FVec3_Cross(from, to);
+	return Quat_Normalize(Quat_New(axis.x, axis.y, axis.z, w));
 }
 
 static inline C3D_FQuat Quat_MyLookAt(C3D_FVec source, C3D_FVec target){
 	C3D_FVec forwardVector = FVec3_New(0.0f, 0.0f, 1.0f);
-	C3D_FVec upVector = FVec3_New(0.0f, 1.0f, 0.0f);
 	C3D_FVec forward = FVec3_Normalize(FVec3_Subtract(target, source));
-	float dot = FVec3_Dot(forwardVector, forward);
-	if (fabsf(dot + 1.0f) < FLT_EPSILON){
-		return FVec4_New(upVector.x, upVector.y, upVector.z, 3.1415926535897932f);
-	}
-	if (fabsf(dot - 1.0f) < FLT_EPSILON){
-		return Quat_Identity();
-	}
-	float rotationAngle = std::acos(dot);
-	C3D_FVec rotationAxis = FVec3_Normalize(FVec3_Cross(forwardVector, forward));
-	return Quat_MyFromAxisAngle(rotationAxis, rotationAngle);
+	return Quat_MyFromVectors(forwardVector, forward);
+}
+
+//Normalized linear blend between two rotations. Takes the shorter way around, and is close enough to a slerp for
+//the small angles between consecutive physics steps.
+static inline C3D_FQuat Quat_MyNlerp(C3D_FQuat from, C3D_FQuat to, float alpha){
+	float sign = Quat_Dot(from, to) < 0.0f ? -1.0f : 1.0f;
+	float beta = 1.0f - alpha;
+	C3D_FQuat result = Quat_New(
+		from.i * beta + to.i * alpha * sign,
+		from.j * beta + to.j * alpha * sign,
+		from.k * beta + to.k * alpha * sign,
+		from.r * beta + to.r * alpha * sign);
+	return Quat_Normalize(result);
 }
 
 static inline C3D_FQuat Quat_MyPitchYawRoll(float pitch, float yaw, float roll, bool bRightSide){
-	float pitch_c = cosf(pitch / 2.0f);
-	float pitch_s = sinf(pitch / 2.0f);
-	float yaw_c = cosf(yaw / 2.0f);
-	float yaw_s = sinf(yaw / 2.0f);
-	float roll_c = cosf(roll / 2.0f);
-	float roll_s = sinf(roll / 2.0f);
+	float pitch_c, pitch_s, yaw_c, yaw_s, roll_c, roll_s;
+	FastMath::SinCos(pitch / 2.0f, pitch_s, pitch_c);
+	FastMath::SinCos(yaw / 2.0f, yaw_s, yaw_c);
+	FastMath::SinCos(roll / 2.0f, roll_s, roll_c);
 
 	if (bRightSide)
 	{
@@ -167,20 +131,21 @@ static inline C3D_FQuat Quat_MyPitchYawRoll(float pitch, float yaw, float roll,
 	}
 }
 
-static inline C3D_FVec Extract_CamPos(C3D_Mtx* inversedViewMatrix){
+static inline C3D_FVec Extract_CamPos(const C3D_Mtx* inversedViewMatrix){
 	return FVec4_New(inversedViewMatrix->r[0].w, inversedViewMatrix->r[1].w, inversedViewMatrix->r[2].w, 1.0f);
 }
 
-static inline C3D_FVec Extract_CamRight(C3D_Mtx* inversedViewMatrix){
+static inline C3D_FVec Extract_CamRight(const C3D_Mtx* inversedViewMatrix){
 	return FVec4_New(inversedViewMatrix->r[0].x, inversedViewMatrix->r[1].x, inversedViewMatrix->r[2].x, 0.0f);
 }
 
-static inline C3D_FVec Extract_CamUp(C3D_Mtx* inversedViewMatrix){
+static inline C3D_FVec Extract_CamUp(const C3D_Mtx* inversedViewMatrix){
 	return FVec4_New(inversedViewMatrix->r[0].y, inversedViewMatrix->r[1].y, inversedViewMatrix->r[2].y, 0.0f);
 }
 
-static inline C3D_FVec Extract_CamForward(C3D_Mtx* inversedViewMatrix){
-	return FVec4_New(inversedViewMatrix->r[0].z, inversedViewMatrix->r[1].z, -inversedViewMatrix->r[2].z, 0.0f);
+static inline C3D_FVec Extract_CamForward(const C3D_Mtx* inversedViewMatrix){
+	//The camera looks down its -Z axis.
+	return FVec4_New(-inversedViewMatrix->r[0].z, -inversedViewMatrix->r[1].z, -inversedViewMatrix->r[2].z, 0.0f);
 }
 
 template <typename Type> std::string ToString(const Type& t){
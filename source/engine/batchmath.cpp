@@ -0,0 +1,384 @@
+#include "batchmath.h"
+
+#if defined(BATCHMATH_SSE)
+#	include <xmmintrin.h>
+#elif defined(BATCHMATH_NEON)
+#	include <arm_neon.h>
+#endif
+
+//Vectors, quaternions and matrix rows are stored backwards, as w, z, y, x (and r, k, j, i), in both citro3d and the
+//host stand-in. The backends load and store them as they are, so the lanes and registers below run in that order too.
+
+namespace Engine {
+	namespace BatchMath {
+		namespace Scalar {
+			void ComposeMatrices(C3D_Mtx* out, const C3D_FVec* position, const C3D_FQuat* rotation, const C3D_FVec* scale, u32 count){
+				for (u32 n = 0; n < count; n++){
+					const C3D_FQuat& q = rotation[n];
+					const C3D_FVec& s = scale[n];
+					float ii = q.i * q.i, jj = q.j * q.j, kk = q.k * q.k;
+					float ij = q.i * q.j, ik = q.i * q.k, jk = q.j * q.k;
+					float ri = q.r * q.i, rj = q.r * q.j, rk = q.r * q.k;
+
+					//Mtx_FromQuat(), with the columns scaled, and the translation in the last column.
+					C3D_Mtx& m = out[n];
+					m.r[0] = FVec4_New((1.0f - 2.0f * (jj + kk)) * s.x, 2.0f * (ij - rk) * s.y, 2.0f * (ik + rj) * s.z, position[n].x);
+					m.r[1] = FVec4_New(2.0f * (ij + rk) * s.x, (1.0f - 2.0f * (ii + kk)) * s.y, 2.0f * (jk - ri) * s.z, position[n].y);
+					m.r[2] = FVec4_New(2.0f * (ik - rj) * s.x, 2.0f * (jk + ri) * s.y, (1.0f - 2.0f * (ii + jj)) * s.z, position[n].z);
+					m.r[3] = FVec4_New(0.0f, 0.0f, 0.0f, 1.0f);
+				}
+			}
+
+			void MultiplyMatrices(C3D_Mtx* out, const C3D_Mtx& left, const C3D_Mtx* right, u32 count){
+				for (u32 n = 0; n < count; n++){
+					for (int row = 0; row < 4; row++){
+						const C3D_FVec& l = left.r[row];
+						for (int i = 0; i < 4; i++){
+							out[n].r[row].c[i] = l.x * right[n].r[0].c[i] + l.y * right[n].r[1].c[i] + l.z * right[n].r[2].c[i] + l.w * right[n].r[3].c[i];
+						}
+					}
+				}
+			}
+
+			void Distances(float* out, const C3D_FVec* position, u32 count, C3D_FVec point){
+				for (u32 n = 0; n < count; n++){
+					float x = position[n].x - point.x, y = position[n].y - point.y, z = position[n].z - point.z;
+					out[n] = std::sqrt(x * x + y * y + z * z);
+				}
+			}
+
+			void PlaneDistances(float* out, const C3D_FVec* position, u32 count, C3D_FVec plane){
+				for (u32 n = 0; n < count; n++){
+					out[n] = plane.x * position[n].x + plane.y * position[n].y + plane.z * position[n].z + plane.w;
+				}
+			}
+		};
+
+#if defined(BATCHMATH_VFP)
+		//The VFP has four banks of eight single registers. s0-s7 are always scalars. With FPSCR.LEN set to 4, an
+		//instruction whose destination is in one of the other banks works on four registers in a row, and takes its last
+		//operand from s0-s7 as a scalar for all four. Everything else compiled code does assumes LEN is 1, so each
+		//kernel sets LEN and puts FPSCR back within one asm block, with no calls in between.
+		//
+		//Building the matrices from quaternions is mostly sums of different products, which does not fit the register
+		//banks, so the compiler's scalar VFP code is used for that.
+
+		const char* Backend(){
+			return "VFP";
+		}
+
+		void ComposeMatrices(C3D_Mtx* out, const C3D_FVec* position, const C3D_FQuat* rotation, const C3D_FVec* scale, u32 count){
+			Scalar::ComposeMatrices(out, position, rotation, scale, count);
+		}
+
+		void MultiplyMatrices(C3D_Mtx* out, const C3D_Mtx& left, const C3D_Mtx* right, u32 count){
+			if (count == 0){
+				return;
+			}
+
+			//right's rows go in s8-s23. Each output row is the sum of those rows times the left row's x, y, z and w, which
+			//are s3, s2, s1, s0 (and s7, s6, s5, s4 for the next row), in the order the rows are stored.
+			u32 fpscr;
+			const float* leftUpper = left.m;
+			const float* leftLower = left.m + 8;
+			__asm__ volatile(
+				"vmrs %[fpscr], fpscr\n\t"
+				"bic r12, %[fpscr], #0x00370000\n\t"
+				"orr r12, r12, #0x00030000\n\t"
+				"vmsr fpscr, r12\n\t"
+				"1:\n\t"
+				"vldmia %[right]!, {s8-s23}\n\t"
+				"vldmia %[leftUpper], {s0-s7}\n\t"
+				"vmul.f32 s24, s8, s3\n\t"
+				"vmla.f32 s24, s12, s2\n\t"
+				"vmla.f32 s24, s16, s1\n\t"
+				"vmla.f32 s24, s20, s0\n\t"
+				"vmul.f32 s28, s8, s7\n\t"
+				"vmla.f32 s28, s12, s6\n\t"
+				"vmla.f32 s28, s16, s5\n\t"
+				"vmla.f32 s28, s20, s4\n\t"
+				"vstmia %[out]!, {s24-s31}\n\t"
+				"vldmia %[leftLower], {s0-s7}\n\t"
+				"vmul.f32 s24, s8, s3\n\t"
+				"vmla.f32 s24, s12, s2\n\t"
+				"vmla.f32 s24, s16, s1\n\t"
+				"vmla.f32 s24, s20, s0\n\t"
+				"vmul.f32 s28, s8, s7\n\t"
+				"vmla.f32 s28, s12, s6\n\t"
+				"vmla.f32 s28, s16, s5\n\t"
+				"vmla.f32 s28, s20, s4\n\t"
+				"vstmia %[out]!, {s24-s31}\n\t"
+				"subs %[count], %[count], #1\n\t"
+				"bne 1b\n\t"
+				"vmsr fpscr, %[fpscr]\n\t"
+				: [fpscr] "=&r" (fpscr), [out] "+r" (out), [right] "+r" (right), [count] "+r" (count)
+				: [leftUpper] "r" (leftUpper), [leftLower] "r" (leftLower)
+				: "r12", "cc", "memory",
+				  "s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11", "s12", "s13", "s14", "s15",
+				  "s16", "s17", "s18", "s19", "s20", "s21", "s22", "s23", "s24", "s25", "s26", "s27", "s28", "s29", "s30", "s31"
+			);
+		}
+
+		void Distances(float* out, const C3D_FVec* position, u32 count, C3D_FVec point){
+			if (count == 0){
+				return;
+			}
+
+			//The difference is squared as a vector of four, then its z, y and x (s25-s27) are summed as scalars, so w is left out.
+			u32 fpscr;
+			__asm__ volatile(
+				"vmrs %[fpscr], fpscr\n\t"
+				"bic r12, %[fpscr], #0x00370000\n\t"
+				"orr r12, r12, #0x00030000\n\t"
+				"vmsr fpscr, r12\n\t"
+				"vldmia %[point], {s16-s19}\n\t"
+				"1:\n\t"
+				"vldmia %[position]!, {s8-s11}\n\t"
+				"vsub.f32 s24, s8, s16\n\t"
+				"vmul.f32 s24, s24, s24\n\t"
+				"vadd.f32 s0, s25, s26\n\t"
+				"vadd.f32 s0, s0, s27\n\t"
+				"vsqrt.f32 s0, s0\n\t"
+				"vstmia %[out]!, {s0}\n\t"
+				"subs %[count], %[count], #1\n\t"
+				"bne 1b\n\t"
+				"vmsr fpscr, %[fpscr]\n\t"
+				: [fpscr] "=&r" (fpscr), [out] "+r" (out), [position] "+r" (position), [count] "+r" (count)
+				: [point] "r" (&point)
+				: "r12", "cc", "memory", "s0", "s8", "s9", "s10", "s11", "s16", "s17", "s18", "s19", "s24", "s25", "s26", "s27"
+			);
+		}
+
+		void PlaneDistances(float* out, const C3D_FVec* position, u32 count, C3D_FVec plane){
+			Scalar::PlaneDistances(out, position, count, plane);
+		}
+
+#elif defined(BATCHMATH_SSE)
+		//Four objects at a time. Each object's vector is loaded as one register, and four of them are transposed so each
+		//register holds one component of all four objects. The math is then the scalar code, four wide, and the results are
+		//transposed back into rows on the way out.
+
+		const char* Backend(){
+			return "SSE";
+		}
+
+		void ComposeMatrices(C3D_Mtx* out, const C3D_FVec* position, const C3D_FQuat* rotation, const C3D_FVec* scale, u32 count){
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 two = _mm_set1_ps(2.0f);
+			const __m128 lastRow = _mm_setr_ps(1.0f, 0.0f, 0.0f, 0.0f);
+			u32 n = 0;
+			for (; n + 4 <= count; n += 4){
+				__m128 r = _mm_loadu_ps(rotation[n].c), k = _mm_loadu_ps(rotation[n + 1].c);
+				__m128 j = _mm_loadu_ps(rotation[n + 2].c), i = _mm_loadu_ps(rotation[n + 3].c);
+				_MM_TRANSPOSE4_PS(r, k, j, i);
+				__m128 tw = _mm_loadu_ps(position[n].c), tz = _mm_loadu_ps(position[n + 1].c);
+				__m128 ty = _mm_loadu_ps(position[n + 2].c), tx = _mm_loadu_ps(position[n + 3].c);
+				_MM_TRANSPOSE4_PS(tw, tz, ty, tx);
+				__m128 sw = _mm_loadu_ps(scale[n].c), sz = _mm_loadu_ps(scale[n + 1].c);
+				__m128 sy = _mm_loadu_ps(scale[n + 2].c), sx = _mm_loadu_ps(scale[n + 3].c);
+				_MM_TRANSPOSE4_PS(sw, sz, sy, sx);
+
+				__m128 ii = _mm_mul_ps(i, i), jj = _mm_mul_ps(j, j), kk = _mm_mul_ps(k, k);
+				__m128 ij = _mm_mul_ps(i, j), ik = _mm_mul_ps(i, k), jk = _mm_mul_ps(j, k);
+				__m128 ri = _mm_mul_ps(r, i), rj = _mm_mul_ps(r, j), rk = _mm_mul_ps(r, k);
+
+				__m128 m00 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(jj, kk))), sx);
+				__m128 m01 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(ij, rk)), sy);
+				__m128 m02 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(ik, rj)), sz);
+				__m128 m10 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(ij, rk)), sx);
+				__m128 m11 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(ii, kk))), sy);
+				__m128 m12 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(jk, ri)), sz);
+				__m128 m20 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(ik, rj)), sx);
+				__m128 m21 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(jk, ri)), sy);
+				__m128 m22 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(ii, jj))), sz);
+
+				//Rows are stored w, z, y, x, so the translation goes first.
+				_MM_TRANSPOSE4_PS(tx, m02, m01, m00);
+				_MM_TRANSPOSE4_PS(ty, m12, m11, m10);
+				_MM_TRANSPOSE4_PS(tz, m22, m21, m20);
+				__m128 row0[4] = { tx, m02, m01, m00 };
+				__m128 row1[4] = { ty, m12, m11, m10 };
+				__m128 row2[4] = { tz, m22, m21, m20 };
+				for (u32 o = 0; o < 4; o++){
+					_mm_storeu_ps(out[n + o].r[0].c, row0[o]);
+					_mm_storeu_ps(out[n + o].r[1].c, row1[o]);
+					_mm_storeu_ps(out[n + o].r[2].c, row2[o]);
+					_mm_storeu_ps(out[n + o].r[3].c, lastRow);
+				}
+			}
+			Scalar::ComposeMatrices(out + n, position + n, rotation + n, scale + n, count - n);
+		}
+
+		void MultiplyMatrices(C3D_Mtx* out, const C3D_Mtx& left, const C3D_Mtx* right, u32 count){
+			//Each output row is right's rows times the left row's x, y, z and w, which stay in registers for the whole batch.
+			__m128 l[4][4];
+			for (int row = 0; row < 4; row++){
+				l[row][0] = _mm_set1_ps(left.r[row].x);
+				l[row][1] = _mm_set1_ps(left.r[row].y);
+				l[row][2] = _mm_set1_ps(left.r[row].z);
+				l[row][3] = _mm_set1_ps(left.r[row].w);
+			}
+			for (u32 n = 0; n < count; n++){
+				__m128 r0 = _mm_loadu_ps(right[n].r[0].c), r1 = _mm_loadu_ps(right[n].r[1].c);
+				__m128 r2 = _mm_loadu_ps(right[n].r[2].c), r3 = _mm_loadu_ps(right[n].r[3].c);
+				for (int row = 0; row < 4; row++){
+					__m128 sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(l[row][0], r0), _mm_mul_ps(l[row][1], r1)),
+						_mm_add_ps(_mm_mul_ps(l[row][2], r2), _mm_mul_ps(l[row][3], r3)));
+					_mm_storeu_ps(out[n].r[row].c, sum);
+				}
+			}
+		}
+
+		void Distances(float* out, const C3D_FVec* position, u32 count, C3D_FVec point){
+			const __m128 px = _mm_set1_ps(point.x), py = _mm_set1_ps(point.y), pz = _mm_set1_ps(point.z);
+			u32 n = 0;
+			for (; n + 4 <= count; n += 4){
+				__m128 w = _mm_loadu_ps(position[n].c), z = _mm_loadu_ps(position[n + 1].c);
+				__m128 y = _mm_loadu_ps(position[n + 2].c), x = _mm_loadu_ps(position[n + 3].c);
+				_MM_TRANSPOSE4_PS(w, z, y, x);
+				x = _mm_sub_ps(x, px);
+				y = _mm_sub_ps(y, py);
+				z = _mm_sub_ps(z, pz);
+				__m128 squared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+				_mm_storeu_ps(out + n, _mm_sqrt_ps(squared));
+			}
+			Scalar::Distances(out + n, position + n, count - n, point);
+		}
+
+		void PlaneDistances(float* out, const C3D_FVec* position, u32 count, C3D_FVec plane){
+			const __m128 nx = _mm_set1_ps(plane.x), ny = _mm_set1_ps(plane.y), nz = _mm_set1_ps(plane.z), d = _mm_set1_ps(plane.w);
+			u32 n = 0;
+			for (; n + 4 <= count; n += 4){
+				__m128 w = _mm_loadu_ps(position[n].c), z = _mm_loadu_ps(position[n + 1].c);
+				__m128 y = _mm_loadu_ps(position[n + 2].c), x = _mm_loadu_ps(position[n + 3].c);
+				_MM_TRANSPOSE4_PS(w, z, y, x);
+				__m128 sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, x), _mm_mul_ps(ny, y)), _mm_add_ps(_mm_mul_ps(nz, z), d));
+				_mm_storeu_ps(out + n, sum);
+			}
+			Scalar::PlaneDistances(out + n, position + n, count - n, plane);
+		}
+
+#elif defined(BATCHMATH_NEON)
+		//Same as the SSE kernels. vld4q_f32() loads four vectors and splits them into components in one go.
+
+		const char* Backend(){
+			return "NEON";
+		}
+
+		//Transposes the 4x4 block of a, b, c and d, so a holds their first lanes, b their second, and so on.
+		static inline void Transpose(float32x4_t& a, float32x4_t& b, float32x4_t& c, float32x4_t& d){
+			float32x4x2_t ab = vtrnq_f32(a, b);
+			float32x4x2_t cd = vtrnq_f32(c, d);
+			a = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+			b = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+			c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+			d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+		}
+
+		void ComposeMatrices(C3D_Mtx* out, const C3D_FVec* position, const C3D_FQuat* rotation, const C3D_FVec* scale, u32 count){
+			const float32x4_t one = vdupq_n_f32(1.0f);
+			const float32x4_t two = vdupq_n_f32(2.0f);
+			const float lastRowValues[4] = { 1.0f, 0.0f, 0.0f, 0.0f };
+			const float32x4_t lastRow = vld1q_f32(lastRowValues);
+			u32 n = 0;
+			for (; n + 4 <= count; n += 4){
+				float32x4x4_t q = vld4q_f32(rotation[n].c);
+				float32x4x4_t t = vld4q_f32(position[n].c);
+				float32x4x4_t s = vld4q_f32(scale[n].c);
+				float32x4_t r = q.val[0], k = q.val[1], j = q.val[2], i = q.val[3];
+				float32x4_t tz = t.val[1], ty = t.val[2], tx = t.val[3];
+				float32x4_t sz = s.val[1], sy = s.val[2], sx = s.val[3];
+
+				float32x4_t ii = vmulq_f32(i, i), jj = vmulq_f32(j, j), kk = vmulq_f32(k, k);
+				float32x4_t ij = vmulq_f32(i, j), ik = vmulq_f32(i, k), jk = vmulq_f32(j, k);
+				float32x4_t ri = vmulq_f32(r, i), rj = vmulq_f32(r, j), rk = vmulq_f32(r, k);
+
+				float32x4_t m00 = vmulq_f32(vsubq_f32(one, vmulq_f32(two, vaddq_f32(jj, kk))), sx);
+				float32x4_t m01 = vmulq_f32(vmulq_f32(two, vsubq_f32(ij, rk)), sy);
+				float32x4_t m02 = vmulq_f32(vmulq_f32(two, vaddq_f32(ik, rj)), sz);
+				float32x4_t m10 = vmulq_f32(vmulq_f32(two, vaddq_f32(ij, rk)), sx);
+				float32x4_t m11 = vmulq_f32(vsubq_f32(one, vmulq_f32(two, vaddq_f32(ii, kk))), sy);
+				float32x4_t m12 = vmulq_f32(vmulq_f32(two, vsubq_f32(jk, ri)), sz);
+				float32x4_t m20 = vmulq_f32(vmulq_f32(two, vsubq_f32(ik, rj)), sx);
+				float32x4_t m21 = vmulq_f32(vmulq_f32(two, vaddq_f32(jk, ri)), sy);
+				float32x4_t m22 = vmulq_f32(vsubq_f32(one, vmulq_f32(two, vaddq_f32(ii, jj))), sz);
+
+				Transpose(tx, m02, m01, m00);
+				Transpose(ty, m12, m11, m10);
+				Transpose(tz, m22, m21, m20);
+				float32x4_t row0[4] = { tx, m02, m01, m00 };
+				float32x4_t row1[4] = { ty, m12, m11, m10 };
+				float32x4_t row2[4] = { tz, m22, m21, m20 };
+				for (u32 o = 0; o < 4; o++){
+					vst1q_f32(out[n + o].r[0].c, row0[o]);
+					vst1q_f32(out[n + o].r[1].c, row1[o]);
+					vst1q_f32(out[n + o].r[2].c, row2[o]);
+					vst1q_f32(out[n + o].r[3].c, lastRow);
+				}
+			}
+			Scalar::ComposeMatrices(out + n, position + n, rotation + n, scale + n, count - n);
+		}
+
+		void MultiplyMatrices(C3D_Mtx* out, const C3D_Mtx& left, const C3D_Mtx* right, u32 count){
+			for (u32 n = 0; n < count; n++){
+				float32x4_t r0 = vld1q_f32(right[n].r[0].c), r1 = vld1q_f32(right[n].r[1].c);
+				float32x4_t r2 = vld1q_f32(right[n].r[2].c), r3 = vld1q_f32(right[n].r[3].c);
+				for (int row = 0; row < 4; row++){
+					const C3D_FVec& l = left.r[row];
+					float32x4_t sum = vmulq_n_f32(r0, l.x);
+					sum = vmlaq_n_f32(sum, r1, l.y);
+					sum = vmlaq_n_f32(sum, r2, l.z);
+					sum = vmlaq_n_f32(sum, r3, l.w);
+					vst1q_f32(out[n].r[row].c, sum);
+				}
+			}
+		}
+
+		void Distances(float* out, const C3D_FVec* position, u32 count, C3D_FVec point){
+			const float32x4_t px = vdupq_n_f32(point.x), py = vdupq_n_f32(point.y), pz = vdupq_n_f32(point.z);
+			u32 n = 0;
+			for (; n + 4 <= count; n += 4){
+				float32x4x4_t p = vld4q_f32(position[n].c);
+				float32x4_t x = vsubq_f32(p.val[3], px), y = vsubq_f32(p.val[2], py), z = vsubq_f32(p.val[1], pz);
+				float32x4_t squared = vmlaq_f32(vmlaq_f32(vmulq_f32(x, x), y, y), z, z);
+				vst1q_f32(out + n, vsqrtq_f32(squared));
+			}
+			Scalar::Distances(out + n, position + n, count - n, point);
+		}
+
+		void PlaneDistances(float* out, const C3D_FVec* position, u32 count, C3D_FVec plane){
+			const float32x4_t d = vdupq_n_f32(plane.w);
+			u32 n = 0;
+			for (; n + 4 <= count; n += 4){
+				float32x4x4_t p = vld4q_f32(position[n].c);
+				float32x4_t sum = vmlaq_n_f32(d, p.val[3], plane.x);
+				sum = vmlaq_n_f32(sum, p.val[2], plane.y);
+				sum = vmlaq_n_f32(sum, p.val[1], plane.z);
+				vst1q_f32(out + n, sum);
+			}
+			Scalar::PlaneDistances(out + n, position + n, count - n, plane);
+		}
+
+#else
+		const char* Backend(){
+			return "scalar";
+		}
+
+		void ComposeMatrices(C3D_Mtx* out, const C3D_FVec* position, const C3D_FQuat* rotation, const C3D_FVec* scale, u32 count){
+			Scalar::ComposeMatrices(out, position, rotation, scale, count);
+		}
+
+		void MultiplyMatrices(C3D_Mtx* out, const C3D_Mtx& left, const C3D_Mtx* right, u32 count){
+			Scalar::MultiplyMatrices(out, left, right, count);
+		}
+
+		void Distances(float* out, const C3D_FVec* position, u32 count, C3D_FVec point){
+			Scalar::Distances(out, position, count, point);
+		}
+
+		void PlaneDistances(float* out, const C3D_FVec* position, u32 count, C3D_FVec plane){
+			Scalar::PlaneDistances(out, position, count, plane);
+		}
+#endif
+	};
+};
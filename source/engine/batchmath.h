@@ -0,0 +1,57 @@
+#pragma once
+
+#ifndef BATCHMATH_HEADER
+#	define BATCHMATH_HEADER
+
+#include "../common.h"
+
+//Picks the kernels' implementation. The 3DS uses the VFP's vector mode, where one instruction works on up to eight
+//registers in a row, and the host uses SSE on x86, or NEON on 64-bit ARM. Anything else, or building with
+//-DBATCHMATH_SCALAR, gets the scalar reference.
+#if defined(BATCHMATH_SCALAR)
+#elif defined(_3DS)
+#	define BATCHMATH_VFP
+#elif defined(__SSE2__)
+#	define BATCHMATH_SSE
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#	define BATCHMATH_NEON
+#else
+#	define BATCHMATH_SCALAR
+#endif
+
+namespace Engine {
+	//Math over whole arrays at once, for the loops that run once per object: building model matrices, and distances to
+	//the camera. One call per array instead of one per object lets each backend keep its constants in registers, and
+	//work on several objects side by side.
+	//
+	//The arrays may hold any number of elements. Outputs must not overlap the inputs, except where noted.
+	namespace BatchMath {
+		//Name of the implementation the kernels below were built with: "VFP", "SSE", "NEON" or "scalar".
+		const char* Backend();
+
+		//out[i] = translation(position[i]) * rotation(rotation[i]) * scale(scale[i]). The rotations must be unit
+		//quaternions. This is how TransformPool builds a transform's local matrix.
+		void ComposeMatrices(C3D_Mtx* out, const C3D_FVec* position, const C3D_FQuat* rotation, const C3D_FVec* scale, u32 count);
+
+		//out[i] = left * right[i], all 4x4, the same as Mtx_Multiply().
+		void MultiplyMatrices(C3D_Mtx* out, const C3D_Mtx& left, const C3D_Mtx* right, u32 count);
+
+		//out[i] = distance from position[i] to point, with the w components left out.
+		void Distances(float* out, const C3D_FVec* position, u32 count, C3D_FVec point);
+
+		//out[i] = dot(plane.xyz, position[i].xyz) + plane.w, the signed distance to the plane for a unit normal, or the
+		//depth along a view matrix's row.
+		void PlaneDistances(float* out, const C3D_FVec* position, u32 count, C3D_FVec plane);
+
+		//Plain C++ versions of the kernels above, built on every platform. The fast ones are checked and timed against
+		//these by tools/mathbench.cpp.
+		namespace Scalar {
+			void ComposeMatrices(C3D_Mtx* out, const C3D_FVec* position, const C3D_FQuat* rotation, const C3D_FVec* scale, u32 count);
+			void MultiplyMatrices(C3D_Mtx* out, const C3D_Mtx& left, const C3D_Mtx* right, u32 count);
+			void Distances(float* out, const C3D_FVec* position, u32 count, C3D_FVec point);
+			void PlaneDistances(float* out, const C3D_FVec* position, u32 count, C3D_FVec plane);
+		};
+	};
+};
+
+#endif
@@ -0,0 +1,341 @@
+#include "bvh.h"
+
+namespace Engine {
+	using Entity::HandleTable;
+
+	const u32 BoundingVolumeHierarchy::None;
+	const u32 BoundingVolumeHierarchy::MaxHeight;
+
+	namespace {
+		//Half the surface area of a box, which is how likely a random ray is to pass through it, give or take a constant.
+		float Area(const float minimum[3], const float maximum[3]){
+			float x = maximum[0] - minimum[0];
+			float y = maximum[1] - minimum[1];
+			float z = maximum[2] - minimum[2];
+			return x * y + y * z + z * x;
+		}
+
+		//Same, for the box around two boxes.
+		float CombinedArea(const float minimumA[3], const float maximumA[3], const float minimumB[3], const float maximumB[3]){
+			float minimum[3], maximum[3];
+			for (u32 axis = 0; axis < 3; axis++){
+				minimum[axis] = std::min(minimumA[axis], minimumB[axis]);
+				maximum[axis] = std::max(maximumA[axis], maximumB[axis]);
+			}
+			return Area(minimum, maximum);
+		}
+	}
+
+	void BoundingVolumeHierarchy::Insert(Handle object, C3D_FVec minimum, C3D_FVec maximum){
+		if (this->Contains(object)){
+			this->Update(object, minimum, maximum);
+			return;
+		}
+
+		u32 slot = HandleTable::IndexOf(object);
+		if (slot >= this->lookup.size()){
+			this->lookup.resize(slot + 1, None);
+		}
+
+		u32 leaf = this->Allocate();
+		Node& node = this->nodes[leaf];
+		node.object = object;
+		node.height = 0;
+		node.left = None;
+		node.right = None;
+		const float low[3] = { minimum.x, minimum.y, minimum.z };
+		const float high[3] = { maximum.x, maximum.y, maximum.z };
+		for (u32 axis = 0; axis < 3; axis++){
+			node.objectMinimum[axis] = low[axis];
+			node.objectMaximum[axis] = high[axis];
+			node.minimum[axis] = low[axis] - this->Margin;
+			node.maximum[axis] = high[axis] + this->Margin;
+		}
+		this->lookup[slot] = leaf;
+		this->InsertLeaf(leaf);
+		this->leafCount++;
+	}
+
+	void BoundingVolumeHierarchy::Remove(Handle object){
+		u32 leaf = this->LeafOf(object);
+		if (leaf == None){
+			return;
+		}
+		this->RemoveLeaf(leaf);
+		this->Free(leaf);
+		this->lookup[HandleTable::IndexOf(object)] = None;
+		this->leafCount--;
+	}
+
+	void BoundingVolumeHierarchy::Clear(){
+		this->nodes.clear();
+		this->lookup.clear();
+		this->root = None;
+		this->freeList = None;
+		this->leafCount = 0;
+	}
+
+	bool BoundingVolumeHierarchy::Contains(Handle object) const {
+		return this->LeafOf(object) != None;
+	}
+
+	u32 BoundingVolumeHierarchy::Size() const {
+		return this->leafCount;
+	}
+
+	u32 BoundingVolumeHierarchy::Height() const {
+		return this->root != None ? (u32) this->nodes[this->root].height : 0;
+	}
+
+	void BoundingVolumeHierarchy::Update(Handle object, C3D_FVec minimum, C3D_FVec maximum){
+		this->Update(object, minimum, maximum, FVec3_New(0.0f, 0.0f, 0.0f));
+	}
+
+	void BoundingVolumeHierarchy::Update(Handle object, C3D_FVec minimum, C3D_FVec maximum, C3D_FVec displacement){
+		u32 leaf = this->LeafOf(object);
+		if (leaf == None){
+			return;
+		}
+
+		Node& node = this->nodes[leaf];
+		node.objectMinimum[0] = minimum.x;
+		node.objectMinimum[1] = minimum.y;
+		node.objectMinimum[2] = minimum.z;
+		node.objectMaximum[0] = maximum.x;
+		node.objectMaximum[1] = maximum.y;
+		node.objectMaximum[2] = maximum.z;
+		if (this->Fits(object, minimum, maximum)){
+			return;
+		}
+
+		//Out of its grown box. Grow a new one around where it is now and where it is heading, and find the leaf a new place.
+		this->RemoveLeaf(leaf);
+		const float ahead[3] = { displacement.x, displacement.y, displacement.z };
+		for (u32 axis = 0; axis < 3; axis++){
+			node.minimum[axis] = node.objectMinimum[axis] - this->Margin + std::min(ahead[axis], 0.0f);
+			node.maximum[axis] = node.objectMaximum[axis] + this->Margin + std::max(ahead[axis], 0.0f);
+		}
+		this->InsertLeaf(leaf);
+	}
+
+	bool BoundingVolumeHierarchy::Fits(Handle object, C3D_FVec minimum, C3D_FVec maximum) const {
+		u32 leaf = this->LeafOf(object);
+		if (leaf == None){
+			return true;
+		}
+		const Node& node = this->nodes[leaf];
+		return minimum.x >= node.minimum[0] && minimum.y >= node.minimum[1] && minimum.z >= node.minimum[2] &&
+			maximum.x <= node.maximum[0] && maximum.y <= node.maximum[1] && maximum.z <= node.maximum[2];
+	}
+
+	u32 BoundingVolumeHierarchy::LeafOf(Handle object) const {
+		u32 slot = HandleTable::IndexOf(object);
+		if (slot >= this->lookup.size()){
+			return None;
+		}
+		u32 leaf = this->lookup[slot];
+		//The slot may have been recycled by another game object since.
+		return (leaf != None && this->nodes[leaf].object == object) ? leaf : None;
+	}
+
+	u32 BoundingVolumeHierarchy::Allocate(){
+		if (this->freeList == None){
+			this->nodes.emplace_back();
+			return (u32) this->nodes.size() - 1;
+		}
+		u32 index = this->freeList;
+		this->freeList = this->nodes[index].parent;
+		return index;
+	}
+
+	void BoundingVolumeHierarchy::Free(u32 index){
+		Node& node = this->nodes[index];
+		node.parent = this->freeList;
+		node.height = -1;
+		node.object = InvalidHandle;
+		this->freeList = index;
+	}
+
+	void BoundingVolumeHierarchy::InsertLeaf(u32 leaf){
+		if (this->root == None){
+			this->root = leaf;
+			this->nodes[leaf].parent = None;
+			return;
+		}
+
+		//Walk down to the node the leaf is cheapest to pair up with. Going into a child costs what every box on the way
+		//grows by, so stop once pairing up right here is cheaper than anything further down.
+		const float* minimum = this->nodes[leaf].minimum;
+		const float* maximum = this->nodes[leaf].maximum;
+		u32 index = this->root;
+		while (this->nodes[index].height > 0){
+			const Node& node = this->nodes[index];
+			float area = Area(node.minimum, node.maximum);
+			float combinedArea = CombinedArea(node.minimum, node.maximum, minimum, maximum);
+			float cost = 2.0f * combinedArea;
+			float inheritedCost = 2.0f * (combinedArea - area);
+
+			float childCost[2];
+			const u32 children[2] = { node.left, node.right };
+			for (u32 c = 0; c < 2; c++){
+				const Node& child = this->nodes[children[c]];
+				childCost[c] = CombinedArea(child.minimum, child.maximum, minimum, maximum) + inheritedCost;
+				if (child.height > 0){
+					childCost[c] -= Area(child.minimum, child.maximum);
+				}
+			}
+			if (cost < childCost[0] && cost < childCost[1]){
+				break;
+			}
+			index = childCost[0] < childCost[1] ? node.left : node.right;
+		}
+
+		//A new node takes the sibling's place, with the sibling and the leaf under it.
+		u32 sibling = index;
+		u32 oldParent = this->nodes[sibling].parent;
+		u32 newParent = this->Allocate();
+		Node& parent = this->nodes[newParent];
+		parent.parent = oldParent;
+		parent.left = sibling;
+		parent.right = leaf;
+		parent.height = 0;
+		parent.object = InvalidHandle;
+		if (oldParent == None){
+			this->root = newParent;
+		}
+		else if (this->nodes[oldParent].left == sibling){
+			this->nodes[oldParent].left = newParent;
+		}
+		else {
+			this->nodes[oldParent].right = newParent;
+		}
+		this->nodes[sibling].parent = newParent;
+		this->nodes[leaf].parent = newParent;
+		this->Refit(newParent);
+	}
+
+	void BoundingVolumeHierarchy::RemoveLeaf(u32 leaf){
+		if (leaf == this->root){
+			this->root = None;
+			return;
+		}
+
+		//The sibling takes the parent's place.
+		u32 parent = this->nodes[leaf].parent;
+		u32 grandParent = this->nodes[parent].parent;
+		u32 sibling = this->nodes[parent].left == leaf ? this->nodes[parent].right : this->nodes[parent].left;
+		this->nodes[sibling].parent = grandParent;
+		this->Free(parent);
+		if (grandParent == None){
+			this->root = sibling;
+			return;
+		}
+		if (this->nodes[grandParent].left == parent){
+			this->nodes[grandParent].left = sibling;
+		}
+		else {
+			this->nodes[grandParent].right = sibling;
+		}
+		this->Refit(grandParent);
+	}
+
+	void BoundingVolumeHierarchy::Refit(u32 index){
+		while (index != None){
+			index = this->Balance(index);
+			Node& node = this->nodes[index];
+			const Node& left = this->nodes[node.left];
+			const Node& right = this->nodes[node.right];
+			node.height = 1 + std::max(left.height, right.height);
+			for (u32 axis = 0; axis < 3; axis++){
+				node.minimum[axis] = std::min(left.minimum[axis], right.minimum[axis]);
+				node.maximum[axis] = std::max(left.maximum[axis], right.maximum[axis]);
+			}
+			index = node.parent;
+		}
+	}
+
+	u32 BoundingVolumeHierarchy::Balance(u32 a){
+		Node& nodeA = this->nodes[a];
+		if (nodeA.height < 2){
+			return a;
+		}
+
+		//The deeper child c moves up into a's place, and a becomes its child. Of c's own children, the deeper one stays
+		//with c, and the other goes to a, in c's old place.
+		u32 b = nodeA.left;
+		u32 c = nodeA.right;
+		s32 balance = this->nodes[c].height - this->nodes[b].height;
+		if (balance > -2 && balance < 2){
+			return a;
+		}
+		bool rightDeeper = balance > 0;
+		if (!rightDeeper){
+			std::swap(b, c);
+		}
+
+		Node& nodeB = this->nodes[b];
+		Node& nodeC = this->nodes[c];
+		u32 f = nodeC.left;
+		u32 g = nodeC.right;
+		Node& nodeF = this->nodes[f];
+		Node& nodeG = this->nodes[g];
+
+		//c goes up.
+		nodeC.left = a;
+		nodeC.parent = nodeA.parent;
+		nodeA.parent = c;
+		if (nodeC.parent == None){
+			this->root = c;
+		}
+		else if (this->nodes[nodeC.parent].left == a){
+			this->nodes[nodeC.parent].left = c;
+		}
+		else {
+			this->nodes[nodeC.parent].right = c;
+		}
+
+		//The shallower of f and g replaces c under a.
+		u32 kept = f, moved = g;
+		if (nodeF.height < nodeG.height){
+			kept = g;
+			moved = f;
+		}
+		nodeC.right = kept;
+		if (rightDeeper){
+			nodeA.right = moved;
+		}
+		else {
+			nodeA.left = moved;
+		}
+		this->nodes[moved].parent = a;
+
+		//a is now below c, so it is rebuilt first.
+		const Node& childB = nodeB;
+		const Node& childMoved = this->nodes[moved];
+		const Node& childKept = this->nodes[kept];
+		nodeA.height = 1 + std::max(childB.height, childMoved.height);
+		nodeC.height = 1 + std::max(nodeA.height, childKept.height);
+		for (u32 axis = 0; axis < 3; axis++){
+			nodeA.minimum[axis] = std::min(childB.minimum[axis], childMoved.minimum[axis]);
+			nodeA.maximum[axis] = std::max(childB.maximum[axis], childMoved.maximum[axis]);
+			nodeC.minimum[axis] = std::min(nodeA.minimum[axis], childKept.minimum[axis]);
+			nodeC.maximum[axis] = std::max(nodeA.maximum[axis], childKept.maximum[axis]);
+		}
+		return c;
+	}
+
+	BoundingVolumeHierarchy::Ray BoundingVolumeHierarchy::MakeRay(C3D_FVec origin, C3D_FVec direction){
+		Ray ray;
+		float length = std::sqrt(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+		const float unit[3] = { direction.x / length, direction.y / length, direction.z / length };
+		ray.origin[0] = origin.x;
+		ray.origin[1] = origin.y;
+		ray.origin[2] = origin.z;
+		for (u32 axis = 0; axis < 3; axis++){
+			//A huge reciprocal instead of an infinite one for rays along an axis, so a ray starting right on a box's side
+			//multiplies 0 by something finite, instead of getting NaN.
+			ray.inverse[axis] = std::abs(unit[axis]) > 1e-20f ? 1.0f / unit[axis] : 1e30f;
+		}
+		return ray;
+	}
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#ifndef BVH_HEADER
+#	define BVH_HEADER
+
+#include "../common.h"
+#include "handle.h"
+
+namespace Engine {
+	using Entity::Handle;
+	using Entity::InvalidHandle;
+
+	//Bounding volume hierarchy over the game objects' bounds, for ray queries like picking. A binary tree of axis aligned
+	//boxes, each holding its two children, with one object per leaf. A ray only goes down into boxes it passes through,
+	//so a query visits a few paths down the tree instead of every object.
+	//
+	//Objects are inserted next to whichever part of the tree grows the least by taking them, and the tree is kept
+	//balanced with rotations on the way back up, like an AVL tree, so it stays about log2(n) deep however objects come and go.
+	//
+	//Leaves are stored with their bounds grown by Margin on every side. An object moving around inside its grown box needs
+	//no changes to the tree at all, and one that leaves it is taken out and put back in, which refits the boxes above it.
+	//A moving object's new box is also stretched along how far it is expected to move, so it stays inside for longer.
+	//The object's own bounds are kept in the leaf too, so hits are still measured against them.
+	class BoundingVolumeHierarchy {
+	public:
+		//How far a leaf's box reaches past the object's bounds.
+		const float Margin = 0.5f;
+
+		//First object along a ray, and how far along the ray it was hit. The object is InvalidHandle for a miss.
+		struct Hit {
+			Handle object;
+			float distance;
+		};
+
+		void Insert(Handle object, C3D_FVec minimum, C3D_FVec maximum);
+		void Remove(Handle object);
+		void Clear();
+		bool Contains(Handle object) const;
+		u32 Size() const;
+
+		//Levels below the root, 0 for a single object or an empty tree.
+		u32 Height() const;
+
+		//Changes the object's bounds. Does nothing if the object is not in the tree. If that moves the object out of its
+		//leaf's box, the new box also covers the bounds moved by displacement, like the object's velocity over a few steps.
+		void Update(Handle object, C3D_FVec minimum, C3D_FVec maximum);
+		void Update(Handle object, C3D_FVec minimum, C3D_FVec maximum, C3D_FVec displacement);
+
+		//Whether the bounds still fit the object's leaf, so Update() would not have to change the tree. Only reads the tree,
+		//so it can run on several threads at once, as long as nothing updates it meanwhile.
+		bool Fits(Handle object, C3D_FVec minimum, C3D_FVec maximum) const;
+
+		//Returns the first object the ray from origin along direction hits within maximumDistance, that the filter accepts.
+		//The direction does not have to be unit length, distances are measured along the normalized direction. A ray
+		//starting inside an object's bounds hits it at 0. The filter is a callable taking a Handle and returning bool, and
+		//is only asked about objects hit closer than the best so far.
+		template<typename Filter> Hit RayCast(C3D_FVec origin, C3D_FVec direction, float maximumDistance, Filter filter) const {
+			Hit hit = { InvalidHandle, maximumDistance };
+			if (this->root == None){
+				return hit;
+			}
+			Ray ray = MakeRay(origin, direction);
+
+			//Nodes still to visit, and where the ray enters them. A child is pushed at most once per level, and rotations
+			//keep the tree balanced, so this is deep enough for far more objects than fit in memory.
+			struct Pending {
+				u32 node;
+				float entry;
+			};
+			Pending stack[MaxHeight];
+			u32 top = 0;
+			float entry;
+			if (Intersect(ray, this->nodes[this->root].minimum, this->nodes[this->root].maximum, hit.distance, entry)){
+				stack[top++] = { this->root, entry };
+			}
+
+			while (top > 0){
+				Pending pending = stack[--top];
+				//A hit found since the node was pushed may already be closer.
+				if (pending.entry > hit.distance){
+					continue;
+				}
+				const Node& node = this->nodes[pending.node];
+				if (node.height == 0){
+					if (Intersect(ray, node.objectMinimum, node.objectMaximum, hit.distance, entry) && filter(node.object)){
+						hit.object = node.object;
+						hit.distance = entry;
+					}
+					continue;
+				}
+
+				//Go into the nearer child first, so a hit in there can cut off the farther one.
+				const Node& left = this->nodes[node.left];
+				const Node& right = this->nodes[node.right];
+				float leftEntry, rightEntry;
+				bool hitsLeft = Intersect(ray, left.minimum, left.maximum, hit.distance, leftEntry);
+				bool hitsRight = Intersect(ray, right.minimum, right.maximum, hit.distance, rightEntry);
+				if (hitsLeft && hitsRight){
+					if (leftEntry < rightEntry){
+						stack[top++] = { node.right, rightEntry };
+						stack[top++] = { node.left, leftEntry };
+					}
+					else {
+						stack[top++] = { node.left, leftEntry };
+						stack[top++] = { node.right, rightEntry };
+					}
+				}
+				else if (hitsLeft){
+					stack[top++] = { node.left, leftEntry };
+				}
+				else if (hitsRight){
+					stack[top++] = { node.right, rightEntry };
+				}
+			}
+			return hit;
+		}
+
+	private:
+		//Stands in for a missing node, like the root of an empty tree.
+		static const u32 None = 0xFFFFFFFF;
+
+		//Deepest the tree can get. An AVL balanced tree this deep holds more leaves than a u32 can count.
+		static const u32 MaxHeight = 64;
+
+		struct Node {
+			//Box around both children, or the leaf's grown box.
+			float minimum[3];
+			float maximum[3];
+			//The object's own bounds, for leaves.
+			float objectMinimum[3];
+			float objectMaximum[3];
+			//Parent, or the next free node while the node is unused.
+			u32 parent;
+			u32 left;
+			u32 right;
+			//Levels below the node. 0 for leaves, -1 for free nodes.
+			s32 height;
+			Handle object;
+		};
+
+		//Ray with the reciprocal of its direction, for testing it against boxes one axis at a time.
+		struct Ray {
+			float origin[3];
+			float inverse[3];
+		};
+
+		std::vector<Node> nodes;
+		u32 root = None;
+		u32 freeList = None;
+		u32 leafCount = 0;
+
+		//The leaf node per game object slot index.
+		std::vector<u32> lookup;
+
+		u32 LeafOf(Handle object) const;
+		u32 Allocate();
+		void Free(u32 index);
+		void InsertLeaf(u32 leaf);
+		void RemoveLeaf(u32 leaf);
+
+		//Rebuilds the box and height of each node from the given one up to the root, rebalancing along the way.
+		void Refit(u32 index);
+
+		//Rotates the subtree under the node if one side is more than a level deeper than the other. Returns the node now
+		//at its place in the tree.
+		u32 Balance(u32 index);
+
+		static Ray MakeRay(C3D_FVec origin, C3D_FVec direction);
+
+		//Where the ray enters the box, if it does within maximumDistance. A ray starting inside enters at 0.
+		static bool Intersect(const Ray& ray, const float minimum[3], const float maximum[3], float maximumDistance, float& entry){
+			float enter = 0.0f;
+			float leave = maximumDistance;
+			for (u32 axis = 0; axis < 3; axis++){
+				float a = (minimum[axis] - ray.origin[axis]) * ray.inverse[axis];
+				float b = (maximum[axis] - ray.origin[axis]) * ray.inverse[axis];
+				enter = std::max(enter, std::min(a, b));
+				leave = std::min(leave, std::max(a, b));
+			}
+			entry = enter;
+			return enter <= leave;
+		}
+	};
+};
+
+#endif
@@ -0,0 +1,654 @@
+#include "collision.h"
+
+namespace Engine {
+	using Entity::Handle;
+	using Entity::HandleTable;
+	using Entity::InvalidHandle;
+
+	const u32 CollisionWorld::Iterations;
+	const u32 CollisionWorld::Ground;
+
+	//Approach speeds below this, in units per reference step (see PhysicsPool::ReferenceRate), do not bounce, so resting
+	//contacts stay at rest. Resting bodies gain 0.4 towards the ground every step, and falling ones top out at 0.5, so
+	//only bodies thrown harder than falling bounce.
+	static const float BounceThreshold = 0.6f;
+
+	//Contacts whose normal is closer to vertical than this hold the upper box up. See Resolve().
+	static const float StackingNormal = 0.7f;
+
+	//Edge axes of the separating axis test have to beat the face axes by this much. Face normals give steadier contacts.
+	static const float EdgeBias = 0.95f;
+
+	void CollisionWorld::Update(PhysicsPool& physics, TransformPool& transforms, float deltaTime){
+		this->BuildBoxes(physics, transforms);
+		this->contacts.clear();
+		this->woken.clear();
+		this->groundContacts = 0;
+		this->pairCount = 0;
+
+		//With every body asleep, nothing can touch anything.
+		if (this->awakeCount == 0){
+			return;
+		}
+		this->SortBoxes();
+
+		//Sweep each band on its own, and against the next band up, since a box can reach into the band after its own.
+		const u32 count = (u32) this->sorted.size();
+		u32 begin = 0;
+		while (begin < count){
+			s32 band = this->sorted[begin].band;
+			u32 end = begin + 1;
+			while (end < count && this->sorted[end].band == band){
+				end++;
+			}
+			this->Sweep(begin, end);
+
+			u32 next = end;
+			while (next < count && this->sorted[next].band == band + 1){
+				next++;
+			}
+			if (next > end){
+				this->Sweep(begin, end, end, next);
+			}
+			begin = end;
+		}
+
+		//The ground plane holds up whatever reaches below it, and does not move. Sleeping boxes need no holding up. These
+		//are found after the boxes' contacts, so boxes woken by those get theirs, and then moved to the front.
+		const u32 boxContacts = (u32) this->contacts.size();
+		const float grown = this->Margin * 0.5f;
+		for (size_t i = 0; i < this->bounds.size(); i++){
+			if (this->bounds[i].minimum[1] < grown && !this->boxes[this->bounds[i].box].asleep){
+				Contact contact;
+				contact.a = Ground;
+				contact.b = this->bounds[i].box;
+				contact.normal = FVec3_New(0.0f, 1.0f, 0.0f);
+				contact.depth = -(this->bounds[i].minimum[1] + grown);
+				contact.level = -std::numeric_limits<float>::max();
+				contact.target = 0.0f;
+				contact.impulse = 0.0f;
+				this->contacts.push_back(contact);
+			}
+		}
+		this->groundContacts = (u32) this->contacts.size() - boxContacts;
+		std::rotate(this->contacts.begin(), this->contacts.begin() + boxContacts, this->contacts.end());
+
+		for (size_t i = 0; i < this->woken.size(); i++){
+			physics.Wake(physics.body[this->boxes[this->woken[i]].body]);
+		}
+
+		this->Resolve(physics, transforms, deltaTime);
+		this->Sleep(physics);
+	}
+
+	void CollisionWorld::CollideSphere(PhysicsPool& physics, TransformPool& transforms, C3D_FVec center, float radius){
+		for (size_t i = 0; i < this->bounds.size(); i++){
+			const Bounds& bounds = this->bounds[i];
+			if (center.x + radius < bounds.minimum[0] || center.x - radius > bounds.maximum[0] ||
+				center.y + radius < bounds.minimum[1] || center.y - radius > bounds.maximum[1] ||
+				center.z + radius < bounds.minimum[2] || center.z - radius > bounds.maximum[2]){
+				continue;
+			}
+			Box& box = this->boxes[bounds.box];
+
+			//Closest point of the box to the sphere's center, in the box's axes.
+			C3D_FVec offset = FVec3_Subtract(center, box.center);
+			float local[3];
+			C3D_FVec closest = box.center;
+			for (u32 k = 0; k < 3; k++){
+				local[k] = FVec3_Dot(offset, box.axis[k]);
+				float clamped = std::max(-box.half[k], std::min(local[k], box.half[k]));
+				closest = FVec3_Add(closest, FVec3_Scale(box.axis[k], clamped));
+			}
+
+			//The normal points from the box to the sphere.
+			C3D_FVec normal;
+			float depth;
+			C3D_FVec difference = FVec3_Subtract(center, closest);
+			float distanceSquared = FVec3_Dot(difference, difference);
+			if (distanceSquared > radius * radius){
+				continue;
+			}
+			if (distanceSquared > 1e-8f){
+				float distance = std::sqrt(distanceSquared);
+				normal = FVec3_Scale(difference, 1.0f / distance);
+				depth = radius - distance;
+			}
+			else {
+				//The center is inside the box, so leave through the nearest face.
+				u32 face = 0;
+				for (u32 k = 1; k < 3; k++){
+					if (box.half[k] - std::abs(local[k]) < box.half[face] - std::abs(local[face])){
+						face = k;
+					}
+				}
+				normal = local[face] < 0.0f ? FVec3_Negate(box.axis[face]) : box.axis[face];
+				depth = radius + box.half[face] - std::abs(local[face]);
+			}
+
+			//The sphere does not give way, so the box takes all of the push, and loses all of its speed towards the sphere.
+			if (box.asleep){
+				box.asleep = false;
+				physics.Wake(physics.body[box.body]);
+			}
+			transforms.MarkDirty(box.slot);
+			C3D_FVec& position = transforms.position[box.slot];
+			position.x -= normal.x * depth;
+			position.y -= normal.y * depth;
+			position.z -= normal.z * depth;
+			box.center = FVec3_Subtract(box.center, FVec3_Scale(normal, depth));
+
+			u32 body = box.body;
+			float approach = physics.vx[body] * normal.x + physics.vy[body] * normal.y + physics.vz[body] * normal.z;
+			if (approach > 0.0f){
+				physics.vx[body] -= normal.x * approach;
+				physics.vy[body] -= normal.y * approach;
+				physics.vz[body] -= normal.z * approach;
+			}
+		}
+	}
+
+	u32 CollisionWorld::PairCount() const {
+		return this->pairCount;
+	}
+
+	u32 CollisionWorld::ContactCount() const {
+		return (u32) this->contacts.size();
+	}
+
+	void CollisionWorld::Reset(){
+		this->boxes.clear();
+		this->bounds.clear();
+		this->previousBoxes.clear();
+		this->previousBounds.clear();
+		this->boxOfBody.clear();
+		this->sorted.clear();
+		this->contacts.clear();
+		this->groundContacts = 0;
+		this->pairCount = 0;
+		this->awakeCount = 0;
+	}
+
+	void CollisionWorld::BuildBoxes(PhysicsPool& physics, const TransformPool& transforms){
+		//Last step's boxes, to copy the sleeping ones from.
+		this->boxes.swap(this->previousBoxes);
+		this->bounds.swap(this->previousBounds);
+		this->boxes.clear();
+		this->bounds.clear();
+		this->boxOfBody.resize(physics.Size(), HandleTable::InvalidValue);
+		this->awakeCount = 0;
+
+		//Sums for the spread of the box centers along each axis.
+		float sum[3] = { 0.0f, 0.0f, 0.0f };
+		float sumSquared[3] = { 0.0f, 0.0f, 0.0f };
+
+		for (u32 i = 0; i < physics.Size(); i++){
+			u32 slot = HandleTable::IndexOf(physics.owner[i]);
+			u32 previous = this->boxOfBody[i];
+			this->boxOfBody[i] = HandleTable::InvalidValue;
+			if (transforms.parent[slot] != InvalidHandle){
+				continue;
+			}
+			this->boxOfBody[i] = (u32) this->boxes.size();
+
+			//A sleeping body's box stays the same, unless something else moved the body, which wakes it. Bodies moved into the
+			//place of a removed one have their boxes built anew.
+			if (physics.asleep[i] && previous < this->previousBoxes.size() && this->previousBoxes[previous].body == i && this->previousBoxes[previous].slot == slot){
+				const Box& old = this->previousBoxes[previous];
+				const C3D_FVec& position = transforms.position[slot];
+				if (old.center.x == position.x && old.center.y == position.y && old.center.z == position.z){
+					//The old box may be from the step the body fell asleep in, when it was still awake.
+					Bounds bounds = this->previousBounds[previous];
+					bounds.box = (u32) this->boxes.size();
+					this->boxes.push_back(old);
+					this->boxes.back().asleep = true;
+					this->bounds.push_back(bounds);
+					float center[3] = { position.x, position.y, position.z };
+					for (u32 k = 0; k < 3; k++){
+						sum[k] += center[k];
+						sumSquared[k] += center[k] * center[k];
+					}
+					continue;
+				}
+				physics.Wake(physics.body[i]);
+			}
+
+			Box box;
+			box.body = i;
+			box.slot = slot;
+			box.center = transforms.position[slot];
+			box.asleep = physics.asleep[i] != 0;
+			this->awakeCount += !box.asleep;
+			const C3D_FVec& extents = physics.halfExtents[i];
+			const C3D_FVec& scale = transforms.scale[slot];
+			box.half[0] = std::abs(extents.x * scale.x);
+			box.half[1] = std::abs(extents.y * scale.y);
+			box.half[2] = std::abs(extents.z * scale.z);
+
+			//Most bodies are never turned, and their boxes are their bounds.
+			const C3D_FQuat& rotation = transforms.rotation[slot];
+			box.aligned = std::abs(rotation.i) < 1e-6f && std::abs(rotation.j) < 1e-6f && std::abs(rotation.k) < 1e-6f;
+			if (box.aligned){
+				box.axis[0] = FVec3_New(1.0f, 0.0f, 0.0f);
+				box.axis[1] = FVec3_New(0.0f, 1.0f, 0.0f);
+				box.axis[2] = FVec3_New(0.0f, 0.0f, 1.0f);
+			}
+			else {
+				C3D_Mtx matrix;
+				Mtx_FromQuat(&matrix, rotation);
+				box.axis[0] = FVec3_New(matrix.r[0].x, matrix.r[1].x, matrix.r[2].x);
+				box.axis[1] = FVec3_New(matrix.r[0].y, matrix.r[1].y, matrix.r[2].y);
+				box.axis[2] = FVec3_New(matrix.r[0].z, matrix.r[1].z, matrix.r[2].z);
+			}
+
+			//Bounds reach as far along each world axis as the box's axes do, scaled by its half sizes.
+			Bounds bounds;
+			bounds.box = (u32) this->boxes.size();
+			float center[3] = { box.center.x, box.center.y, box.center.z };
+			for (u32 k = 0; k < 3; k++){
+				float reach = 0.0f;
+				for (u32 c = 0; c < 3; c++){
+					const C3D_FVec& axis = box.axis[c];
+					float component = k == 0 ? axis.x : (k == 1 ? axis.y : axis.z);
+					reach += std::abs(component) * box.half[c];
+				}
+				bounds.minimum[k] = center[k] - reach - this->Margin * 0.5f;
+				bounds.maximum[k] = center[k] + reach + this->Margin * 0.5f;
+				sum[k] += center[k];
+				sumSquared[k] += center[k] * center[k];
+			}
+			this->boxes.push_back(box);
+			this->bounds.push_back(bounds);
+		}
+
+		//Sort along the axis the boxes are most spread out along, and band along the next one. Switching throws away the
+		//order built up so far, so only switch for an axis that is clearly better.
+		float spread[3];
+		for (u32 k = 0; k < 3; k++){
+			spread[k] = sumSquared[k] - sum[k] * sum[k] / (float) std::max<size_t>(this->boxes.size(), 1);
+		}
+		u32 sortAxis = this->sortAxis, bandAxis = this->bandAxis;
+		for (u32 k = 0; k < 3; k++){
+			if (spread[k] > spread[sortAxis] * 2.0f){
+				sortAxis = k;
+			}
+		}
+		if (bandAxis == sortAxis){
+			u32 first = (sortAxis + 1) % 3, second = (sortAxis + 2) % 3;
+			bandAxis = spread[second] > spread[first] ? second : first;
+		}
+		else if (spread[3 - sortAxis - bandAxis] > spread[bandAxis] * 2.0f){
+			bandAxis = 3 - sortAxis - bandAxis;
+		}
+		bool resort = sortAxis != this->sortAxis || bandAxis != this->bandAxis;
+		this->sortAxis = sortAxis;
+		this->bandAxis = bandAxis;
+
+		//Bands are at least as wide as the largest box, so a box never reaches past the band after its own. They are made
+		//twice that, and left alone until the largest box outgrows them, or shrinks to a quarter of them.
+		float largest = 1e-3f;
+		for (size_t i = 0; i < this->bounds.size(); i++){
+			largest = std::max(largest, this->bounds[i].maximum[bandAxis] - this->bounds[i].minimum[bandAxis]);
+		}
+		if (this->bandWidth < largest || this->bandWidth > largest * 4.0f){
+			this->bandWidth = largest * 2.0f;
+			resort = true;
+		}
+		for (size_t i = 0; i < this->bounds.size(); i++){
+			this->bounds[i].band = (s32) std::floor(this->bounds[i].minimum[bandAxis] / this->bandWidth);
+		}
+		if (resort){
+			this->sorted.clear();
+		}
+	}
+
+	void CollisionWorld::SortBoxes(){
+		//Drop the boxes that are gone, bring the bounds of the others up to date, keeping their order, and add new boxes at the end.
+		const u32 count = (u32) this->bounds.size();
+		u32 kept = 0;
+		for (size_t i = 0; i < this->sorted.size(); i++){
+			if (this->sorted[i].box < count){
+				this->sorted[kept++] = this->bounds[this->sorted[i].box];
+			}
+		}
+		this->sorted.resize(kept);
+
+		//The boxes kept are the first ones, as the boxes are built in body order.
+		for (u32 index = kept; index < count; index++){
+			this->sorted.push_back(this->bounds[index]);
+		}
+
+		const u32 axis = this->sortAxis;
+		auto before = [axis](const Bounds& a, const Bounds& b){
+			return a.band < b.band || (a.band == b.band && a.minimum[axis] < b.minimum[axis]);
+		};
+
+		//Nothing to start from the first time, or after the axes changed, so that needs a full sort.
+		if (kept == 0){
+			std::sort(this->sorted.begin(), this->sorted.end(), before);
+			return;
+		}
+
+		//Insertion sort. Nearly sorted input makes it close to linear, and new boxes only move as far as they have to.
+		for (u32 i = 1; i < count; i++){
+			Bounds entry = this->sorted[i];
+			u32 j = i;
+			while (j > 0 && before(entry, this->sorted[j - 1])){
+				this->sorted[j] = this->sorted[j - 1];
+				j--;
+			}
+			this->sorted[j] = entry;
+		}
+	}
+
+	void CollisionWorld::Sweep(u32 begin, u32 end){
+		//Once a box starts past the end of the current one, so do all the boxes after it.
+		const u32 axis = this->sortAxis;
+		for (u32 i = begin; i < end; i++){
+			const Bounds& a = this->sorted[i];
+			for (u32 j = i + 1; j < end && this->sorted[j].minimum[axis] <= a.maximum[axis]; j++){
+				this->Test(a, this->sorted[j]);
+			}
+		}
+	}
+
+	void CollisionWorld::Sweep(u32 begin, u32 end, u32 otherBegin, u32 otherEnd){
+		//Both runs are sorted, so walk them together, always taking the box that starts first, and testing it against the
+		//boxes of the other run that start before it ends.
+		const u32 axis = this->sortAxis;
+		u32 i = begin, j = otherBegin;
+		while (i < end && j < otherEnd){
+			const Bounds& a = this->sorted[i];
+			const Bounds& b = this->sorted[j];
+			if (a.minimum[axis] <= b.minimum[axis]){
+				for (u32 k = j; k < otherEnd && this->sorted[k].minimum[axis] <= a.maximum[axis]; k++){
+					this->Test(a, this->sorted[k]);
+				}
+				i++;
+			}
+			else {
+				for (u32 k = i; k < end && this->sorted[k].minimum[axis] <= b.maximum[axis]; k++){
+					this->Test(this->sorted[k], b);
+				}
+				j++;
+			}
+		}
+	}
+
+	void CollisionWorld::Test(const Bounds& a, const Bounds& b){
+		//The sweep only checked the sort axis. Most pairs fail on the other two, in no particular pattern, so that is
+		//worked out without branching.
+		bool overlapping = (b.minimum[0] <= a.maximum[0]) & (a.minimum[0] <= b.maximum[0]) &
+			(b.minimum[1] <= a.maximum[1]) & (a.minimum[1] <= b.maximum[1]) &
+			(b.minimum[2] <= a.maximum[2]) & (a.minimum[2] <= b.maximum[2]);
+		Box& boxA = this->boxes[a.box];
+		Box& boxB = this->boxes[b.box];
+		if (!overlapping || (boxA.asleep && boxB.asleep)){
+			return;
+		}
+
+		this->pairCount++;
+		Contact contact;
+		if (this->Overlap(boxA, boxB, contact.normal, contact.depth)){
+			//The awake box may be about to push the sleeping one.
+			if (boxA.asleep || boxB.asleep){
+				u32 sleeper = boxA.asleep ? a.box : b.box;
+				this->boxes[sleeper].asleep = false;
+				this->woken.push_back(sleeper);
+			}
+			contact.a = a.box;
+			contact.b = b.box;
+			contact.level = std::min(boxA.center.y, boxB.center.y);
+			contact.target = 0.0f;
+			contact.impulse = 0.0f;
+			this->contacts.push_back(contact);
+		}
+	}
+
+	bool CollisionWorld::Overlap(const Box& a, const Box& b, C3D_FVec& normal, float& depth) const {
+		C3D_FVec offset = FVec3_Subtract(b.center, a.center);
+
+		//Boxes that are not turned overlap by as much as their bounds do. Apart along several axes, the largest gap counts.
+		if (a.aligned && b.aligned){
+			float distance[3] = { offset.x, offset.y, offset.z };
+			u32 best = 3;
+			for (u32 k = 0; k < 3; k++){
+				float overlap = a.half[k] + b.half[k] - std::abs(distance[k]);
+				if (overlap <= -this->Margin){
+					return false;
+				}
+				if (best == 3 || overlap < depth){
+					best = k;
+					depth = overlap;
+				}
+			}
+			normal = distance[best] < 0.0f ? FVec3_Negate(a.axis[best]) : a.axis[best];
+			return true;
+		}
+
+		//Separating axis test over the 3 face normals of each box and the 9 cross products of their edges. The boxes
+		//overlap unless one of them separates them, and the axis they overlap the least along is the contact normal.
+		//An axis only rules the pair out once it separates them by more than the margin.
+		bool found = false;
+		auto test = [&](C3D_FVec axis, bool edge) -> bool {
+			float lengthSquared = FVec3_Dot(axis, axis);
+			if (lengthSquared < 1e-6f){
+				//Parallel edges. The face axes already cover this direction.
+				return true;
+			}
+			axis = FVec3_Scale(axis, 1.0f / std::sqrt(lengthSquared));
+			float reachA = 0.0f, reachB = 0.0f;
+			for (u32 k = 0; k < 3; k++){
+				reachA += a.half[k] * std::abs(FVec3_Dot(a.axis[k], axis));
+				reachB += b.half[k] * std::abs(FVec3_Dot(b.axis[k], axis));
+			}
+			float distance = FVec3_Dot(offset, axis);
+			float overlap = reachA + reachB - std::abs(distance);
+			if (overlap <= -this->Margin){
+				return false;
+			}
+			if (!found || overlap < (edge ? depth * EdgeBias : depth)){
+				found = true;
+				depth = overlap;
+				normal = distance < 0.0f ? FVec3_Negate(axis) : axis;
+			}
+			return true;
+		};
+
+		for (u32 k = 0; k < 3; k++){
+			if (!test(a.axis[k], false) || !test(b.axis[k], false)){
+				return false;
+			}
+		}
+		for (u32 i = 0; i < 3; i++){
+			for (u32 j = 0; j < 3; j++){
+				if (!test(FVec3_Cross(a.axis[i], b.axis[j]), true)){
+					return false;
+				}
+			}
+		}
+		return found;
+	}
+
+	void CollisionWorld::Resolve(PhysicsPool& physics, TransformPool& transforms, float deltaTime){
+		//Work on a copy of the velocities, by box, with one more for the ground at the end. The ground never moves, so
+		//whatever is added to its velocity is thrown away.
+		const u32 ground = (u32) this->boxes.size();
+		this->velocities.resize(ground + 1);
+		for (u32 i = 0; i < ground; i++){
+			u32 body = this->boxes[i].body;
+			this->velocities[i] = FVec3_New(physics.vx[body], physics.vy[body], physics.vz[body]);
+		}
+		C3D_FVec* velocity = this->velocities.data();
+		auto index = [ground](u32 box){
+			return box == Ground ? ground : box;
+		};
+
+		//Work from the ground up, so the impulses holding up a stack reach its top within a few iterations. The ground
+		//contacts are first already.
+		std::sort(this->contacts.begin() + this->groundContacts, this->contacts.end(), [](const Contact& a, const Contact& b){
+			return a.level < b.level;
+		});
+
+		//Velocities are in units per reference step, and a step moves bodies by velocity times frames. Boxes apart may
+		//close the gap this step, and no faster. Touching ones closing fast enough bounce back with a part of their approach speed.
+		const float frames = deltaTime * physics.ReferenceRate;
+		for (size_t c = 0; c < this->contacts.size(); c++){
+			Contact& contact = this->contacts[c];
+			if (contact.depth < 0.0f){
+				contact.target = contact.depth / frames;
+				continue;
+			}
+			C3D_FVec relative = FVec3_Subtract(velocity[contact.b], velocity[index(contact.a)]);
+			float approach = FVec3_Dot(relative, contact.normal);
+			if (approach < -BounceThreshold){
+				contact.target = -approach * this->Restitution;
+			}
+		}
+
+		//Every body weighs the same, and the ground is immovable. Against another body, an impulse changes both velocities
+		//by half of what it takes, in opposite directions. Against the ground, the body takes all of it. The total normal
+		//impulse of a contact never goes below zero, as contacts can only push.
+		for (u32 iteration = 0; iteration < Iterations; iteration++){
+			for (size_t c = 0; c < this->contacts.size(); c++){
+				Contact& contact = this->contacts[c];
+				const float share = contact.a == Ground ? 1.0f : 0.5f;
+				C3D_FVec& velocityA = velocity[index(contact.a)];
+				C3D_FVec& velocityB = velocity[contact.b];
+				C3D_FVec relative = FVec3_Subtract(velocityB, velocityA);
+				float speed = FVec3_Dot(relative, contact.normal);
+				float impulse = std::max(contact.impulse + (contact.target - speed) * share, 0.0f);
+				float change = impulse - contact.impulse;
+				contact.impulse = impulse;
+
+				//Friction works against the sliding left over, up to its share of the normal impulse.
+				C3D_FVec slide = FVec3_Subtract(relative, FVec3_Scale(contact.normal, speed));
+				float slideSquared = FVec3_Dot(slide, slide);
+				float friction = 0.0f;
+				if (slideSquared > 1e-12f){
+					float slideLength = std::sqrt(slideSquared);
+					friction = std::min(slideLength * share, this->Friction * contact.impulse) / slideLength;
+				}
+
+				C3D_FVec push = FVec3_Subtract(FVec3_Scale(contact.normal, change), FVec3_Scale(slide, friction));
+				velocityA = FVec3_Subtract(velocityA, push);
+				velocityB = FVec3_Add(velocityB, push);
+			}
+			velocity[ground] = FVec3_New(0.0f, 0.0f, 0.0f);
+		}
+
+		//Last, one more pass from the ground up in which the lower box of every contact that holds another up counts as
+		//immovable (shock propagation). Whatever the iterations left over is taken out of the upper box alone, so stacks
+		//of equal weights cannot sink into each other. The same goes for pushing the overlap apart below.
+		auto lowerHolds = [](const Contact& contact){
+			return contact.a == Ground || std::abs(contact.normal.y) > StackingNormal;
+		};
+		auto aBelow = [this](const Contact& contact){
+			return contact.a == Ground || this->boxes[contact.a].center.y < this->boxes[contact.b].center.y;
+		};
+		for (size_t c = 0; c < this->contacts.size(); c++){
+			const Contact& contact = this->contacts[c];
+			if (!lowerHolds(contact)){
+				continue;
+			}
+			C3D_FVec& velocityA = velocity[index(contact.a)];
+			C3D_FVec& velocityB = velocity[contact.b];
+			float speed = FVec3_Dot(FVec3_Subtract(velocityB, velocityA), contact.normal);
+			if (speed >= contact.target){
+				continue;
+			}
+			C3D_FVec push = FVec3_Scale(contact.normal, contact.target - speed);
+			if (aBelow(contact)){
+				velocityB = FVec3_Add(velocityB, push);
+			}
+			else {
+				velocityA = FVec3_Subtract(velocityA, push);
+			}
+		}
+
+		for (u32 i = 0; i < ground; i++){
+			u32 body = this->boxes[i].body;
+			physics.vx[body] = velocity[i].x;
+			physics.vy[body] = velocity[i].y;
+			physics.vz[body] = velocity[i].z;
+		}
+
+		//Push what is left of the overlap apart, half on each body, or all on the upper one if the lower one holds it up.
+		for (size_t c = 0; c < this->contacts.size(); c++){
+			const Contact& contact = this->contacts[c];
+			float push = std::max(contact.depth - this->Slop, 0.0f) * this->Correction;
+			if (push <= 0.0f){
+				continue;
+			}
+			float pushA = push * 0.5f, pushB = push * 0.5f;
+			if (lowerHolds(contact)){
+				bool below = aBelow(contact);
+				pushA = below ? 0.0f : push;
+				pushB = below ? push : 0.0f;
+			}
+			if (contact.a != Ground){
+				transforms.MarkDirty(this->boxes[contact.a].slot);
+				C3D_FVec& positionA = transforms.position[this->boxes[contact.a].slot];
+				positionA.x -= contact.normal.x * pushA;
+				positionA.y -= contact.normal.y * pushA;
+				positionA.z -= contact.normal.z * pushA;
+			}
+			transforms.MarkDirty(this->boxes[contact.b].slot);
+			C3D_FVec& positionB = transforms.position[this->boxes[contact.b].slot];
+			positionB.x += contact.normal.x * pushB;
+			positionB.y += contact.normal.y * pushB;
+			positionB.z += contact.normal.z * pushB;
+		}
+	}
+
+	void CollisionWorld::Sleep(PhysicsPool& physics){
+		//Every contact joins two boxes into one island. The ground joins nothing, or everything on it would be one island.
+		const u32 count = (u32) this->boxes.size();
+		this->islands.resize(count);
+		this->restless.assign(count, 0);
+		for (u32 i = 0; i < count; i++){
+			this->islands[i] = i;
+		}
+		for (size_t c = this->groundContacts; c < this->contacts.size(); c++){
+			u32 a = this->FindIsland(this->contacts[c].a);
+			u32 b = this->FindIsland(this->contacts[c].b);
+			this->islands[a] = b;
+		}
+
+		//An island may sleep once all of its bodies have been resting long enough, and are still slow after this step's contacts.
+		const float sleepSpeedSquared = physics.SleepSpeed * physics.SleepSpeed;
+		for (u32 i = 0; i < count; i++){
+			if (this->boxes[i].asleep){
+				continue;
+			}
+			u32 body = this->boxes[i].body;
+			float speedSquared = physics.vx[body] * physics.vx[body] + physics.vy[body] * physics.vy[body] + physics.vz[body] * physics.vz[body];
+			if (physics.restTime[body] < physics.SleepTime || speedSquared >= sleepSpeedSquared){
+				this->restless[this->FindIsland(i)] = 1;
+			}
+		}
+		for (u32 i = 0; i < count; i++){
+			if (this->boxes[i].asleep){
+				continue;
+			}
+			u32 root = this->FindIsland(i);
+			if (!this->restless[root]){
+				physics.Sleep(physics.body[this->boxes[i].body], physics.body[this->boxes[root].body]);
+			}
+		}
+	}
+
+	u32 CollisionWorld::FindIsland(u32 box){
+		//Follow the tree up to the root, then point everything on the way straight at it.
+		u32 root = box;
+		while (this->islands[root] != root){
+			root = this->islands[root];
+		}
+		while (box != root){
+			u32 next = this->islands[box];
+			this->islands[box] = root;
+			box = next;
+		}
+		return root;
+	}
+};
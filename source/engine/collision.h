@@ -0,0 +1,162 @@
+#pragma once
+
+#ifndef COLLISION_HEADER
+#	define COLLISION_HEADER
+
+#include "../common.h"
+#include "pool.h"
+
+namespace Engine {
+	using Entity::PhysicsPool;
+	using Entity::TransformPool;
+
+	//Rigid body collision between the physics bodies, run once per physics step, between PhysicsPool::Accelerate() and
+	//PhysicsPool::Integrate(), so contacts change the velocities before they move anything. Every body is a box (see
+	//PhysicsComponent::halfExtents), turned and scaled with its transform.
+	//
+	//The broadphase is sweep and prune. The boxes' bounds are kept sorted along one axis, and only boxes whose bounds
+	//overlap along it are tested any further. Bodies barely move between steps, so the order from the last step is
+	//nearly sorted already, and an insertion sort brings it up to date in close to linear time. The axis is the one the
+	//bodies are most spread out along, so tall stacks and long rows both sort along the axis that tells them apart.
+	//
+	//Bodies spread out over a floor overlap along any one axis in whole rows, so the bounds are also cut into bands along
+	//a second axis, each at least as wide as the largest box. Each band is swept on its own, and against the next one.
+	//
+	//The narrowphase is a plain overlap test for boxes that are not turned, and the separating axis test for those that
+	//are. It gives the contact normal and how deep the boxes overlap, or how far apart they are, for boxes closer than
+	//Margin. Those contacts let the boxes close the gap this step, but no more, so falling boxes land without sinking in.
+	//Boxes reaching below the ground plane get a contact with it too. Contacts are then resolved with impulses along the
+	//normal, with friction, over a few iterations so stacks settle, and any remaining overlap is pushed apart.
+	//
+	//Sleeping bodies (see PhysicsPool::Sleep()) stay in the broadphase as obstacles, but pairs of them are not tested,
+	//and they get no contact with the ground. A contact with an awake body wakes them. After resolving, the bodies
+	//touching each other are gathered into islands, and islands whose bodies have all been resting long enough are put
+	//to sleep together, so a stack never sleeps with a body in it still moving.
+	//
+	//Bodies have no mass or spin of their own, so every body weighs the same, and impulses only change velocities.
+	//Bodies attached to another transform, like a held object, are left out, the same as in PhysicsPool.
+	class CollisionWorld {
+	public:
+		//Impulse passes over the contacts per step.
+		static const u32 Iterations = 4;
+
+		//Fraction of the approach speed a contact bounces back with.
+		const float Restitution = 0.2f;
+
+		//Friction coefficient. A contact can take away at most this times its normal impulse sideways.
+		const float Friction = 0.5f;
+
+		//Overlap left alone, so resting contacts stay in contact instead of jittering, and the part of the rest pushed out per step.
+		const float Slop = 0.01f;
+		const float Correction = 0.8f;
+
+		//Gap below which boxes get a contact, about as far as a falling body moves in a step at PhysicsPool::ReferenceRate.
+		const float Margin = 0.5f;
+
+		//Finds the contacts between every pair of bodies, and between them and the ground, and resolves them for a step of deltaTime seconds.
+		void Update(PhysicsPool& physics, TransformPool& transforms, float deltaTime);
+
+		//Pushes the bodies out of a sphere that does not move for anyone, like the player, and stops them moving into it.
+		//Wakes the bodies it touches. Uses the boxes of the last Update().
+		void CollideSphere(PhysicsPool& physics, TransformPool& transforms, C3D_FVec center, float radius);
+
+		//Pairs the broadphase let through, and the ones that were actually touching, in the last Update().
+		u32 PairCount() const;
+		u32 ContactCount() const;
+
+		//Forgets the boxes of the last Update(), and their order. For when the pool's bodies were all replaced, like after
+		//loading a scene, so a new body at the index of an old one does not get its box.
+		void Reset();
+
+	private:
+		//A body's box in world space. Axes are the columns of its rotation.
+		struct Box {
+			C3D_FVec center;
+			C3D_FVec axis[3];
+			float half[3];
+			//Index of the body in the physics pool, and of its transform.
+			u32 body;
+			u32 slot;
+			//True if the box is not turned, so its axes are the world axes.
+			bool aligned;
+			//True while the body sleeps.
+			bool asleep;
+		};
+
+		//Stands in for a box index in contacts with the ground plane, at y = 0.
+		static const u32 Ground = 0xFFFFFFFF;
+
+		//Contact between two boxes, by index, or between the ground (as a) and a box.
+		struct Contact {
+			u32 a;
+			u32 b;
+			//Points from a to b.
+			C3D_FVec normal;
+			//Overlap along the normal, or the gap between the boxes, as a negative depth.
+			float depth;
+			//Height of the lower box's center, for resolving stacks from the bottom up.
+			float level;
+			//Lowest speed along the normal the contact allows, and the normal impulse so far.
+			float target;
+			float impulse;
+		};
+
+		//World space box around a Box, grown by half the margin on every side, and the index of the box. Kept apart from the boxes, so the sweep reads a small
+		//contiguous array, and only goes to the boxes for pairs whose bounds overlap.
+		struct Bounds {
+			float minimum[3];
+			float maximum[3];
+			u32 box;
+			//Band along bandAxis the lower end of the bounds falls in.
+			s32 band;
+		};
+
+		std::vector<Box> boxes;
+		std::vector<Bounds> bounds;
+		u32 awakeCount = 0;
+
+		//Last step's boxes, and the box of each body in the pool, to carry the boxes of sleeping bodies over.
+		std::vector<Box> previousBoxes;
+		std::vector<Bounds> previousBounds;
+		std::vector<u32> boxOfBody;
+
+		//The bounds of the boxes, sorted by band, then by their lower end along sortAxis. The order is kept between steps.
+		std::vector<Bounds> sorted;
+		u32 sortAxis = 0;
+		u32 bandAxis = 2;
+		float bandWidth = 0.0f;
+
+		//Contacts with the ground come first, then the ones between boxes.
+		std::vector<Contact> contacts;
+		u32 groundContacts = 0;
+		u32 pairCount = 0;
+
+		//Velocities of the boxes' bodies while Resolve() works on them.
+		std::vector<C3D_FVec> velocities;
+
+		//Sleeping boxes a contact woke up in this Update(). Then the islands, as a union find tree by box, and whether each
+		//island's root has a body in it that is not ready to sleep.
+		std::vector<u32> woken;
+		std::vector<u32> islands;
+		std::vector<u8> restless;
+
+		//Builds the boxes and their bounds, and wakes sleeping bodies something else has moved.
+		void BuildBoxes(PhysicsPool& physics, const TransformPool& transforms);
+		void SortBoxes();
+
+		//Tests the pairs within sorted[begin, end), or between it and sorted[otherBegin, otherEnd), that overlap along sortAxis.
+		void Sweep(u32 begin, u32 end);
+		void Sweep(u32 begin, u32 end, u32 otherBegin, u32 otherEnd);
+
+		//Bounds check on all three axes, then the narrowphase. Adds a contact if the boxes touch.
+		void Test(const Bounds& a, const Bounds& b);
+		bool Overlap(const Box& a, const Box& b, C3D_FVec& normal, float& depth) const;
+		void Resolve(PhysicsPool& physics, TransformPool& transforms, float deltaTime);
+
+		//Puts the islands that have come to rest to sleep.
+		void Sleep(PhysicsPool& physics);
+		u32 FindIsland(u32 box);
+	};
+};
+
+#endif
@@ -4,61 +4,70 @@
 #	define COMPONENT_HEADER
 
 #include "../common.h"
-#include "../entity/entity.h"
+#include "handle.h"
 
 namespace Entity {
-	class GameObject;
-	
 	enum class ComponentType {
 		AbstractComponent,
 		PhysicsComponent,
 		TransformComponent
 	};
-	
+
+	//Number of ComponentType values. Each one is a bit of a ComponentMask.
+	static const u32 ComponentTypeCount = 3;
+	typedef u32 ComponentMask;
+	static_assert(ComponentTypeCount <= sizeof(ComponentMask) * 8, "ComponentMask has a bit per component type.");
+
+	//Components are plain values describing the initial state of a game object's component.
+	//AddComponent<T>() copies them into the component pools (see pool.h), where the data actually lives
+	//and gets updated by a system loop over the whole pool.
 	struct Component {
 		ComponentType type;
-		std::shared_ptr<GameObject> parent;
-		
+
 		Component();
-		virtual ~Component();
-		
-		void SetParent(GameObject* parent);
-		
-		virtual void Initialize() = 0;
-		virtual void Update() = 0;
-		virtual void RenderUpdate(C3D_Mtx& viewMatrix, C3D_Mtx* modelMatrix) = 0;
-		virtual void Out() = 0;
 	};
 
 	class PhysicsComponent : public Component {
 	public:
 		float ax, ay, az, vx, vy, vz;
-		const float GravityY = -0.4f;
 
-		PhysicsComponent();
-		PhysicsComponent(PhysicsComponent& copy);
+		//Half the size of the body's collision box along each of its axes, in model space, before the transform's scale.
+		//The box is centered on the transform. Defaults to the unit cube the game objects are drawn with.
+		C3D_FVec halfExtents;
 
-		void Initialize() override;
-		void Update() override;
-		void RenderUpdate(C3D_Mtx& viewMatrix, C3D_Mtx* modelMatrix) override;
-		void Out() override;
+		PhysicsComponent();
 	};
-	
+
 	class TransformComponent : public Component {
 	public:
 		C3D_FVec scale;
 		C3D_FVec position;
 		C3D_FQuat rotation;
-		float testAngle;
-		//float rotationPitch, rotationYaw, rotationRoll;
-		
+
+		//Game object whose transform the values above are relative to, or InvalidHandle for world space.
+		Handle parent;
+
 		TransformComponent();
-		TransformComponent(TransformComponent& copy);
-		
-		void Initialize() override;
-		void Update() override;
-		void RenderUpdate(C3D_Mtx& viewMatrix, C3D_Mtx* modelMatrix) override;
-		void Out() override;
+	};
+
+	//Compile time ID of each component type, so finding a component is an array index, without RTTI. Index is the
+	//component's ComponentType, and Bit its bit in a ComponentMask. Every component type needs one of these.
+	template<typename Derived> struct ComponentTraits {
+		static_assert(sizeof(Derived) == 0, "Component type has no ComponentTraits specialization.");
+	};
+
+	template<> struct ComponentTraits<PhysicsComponent> {
+		enum : u32 {
+			Index = (u32) ComponentType::PhysicsComponent,
+			Bit = 1U << Index
+		};
+	};
+
+	template<> struct ComponentTraits<TransformComponent> {
+		enum : u32 {
+			Index = (u32) ComponentType::TransformComponent,
+			Bit = 1U << Index
+		};
 	};
 };
 
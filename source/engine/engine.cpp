@@ -6,6 +6,20 @@ namespace Engine {
 		return core;
 	}
 
+	Core::Core(){
+		this->physicsStep = 1.0f / 60.0f;
+		ComponentPools::Instance().physics.SetStepLength(this->physicsStep);
+		this->maxPhysicsSteps = 4;
+		this->physicsAccumulator = 0.0f;
+		this->interpolationAlpha = 0.0f;
+		this->lastTick = 0;
+		this->frameSync = true;
+		this->drawnObjects = 0;
+		this->culledObjects = 0;
+		this->reducedObjects = 0;
+		Mtx_Identity(&this->inverseViewMatrix);
+	}
+
 	Core::~Core(){ 	}
 
 	void Core::Initialize(){
@@ -48,9 +62,10 @@ namespace Engine {
 		//Initialize attributes, and then configure them for use with vertex shader.
 		C3D_AttrInfo* attributeInfo = C3D_GetAttrInfo();
 		AttrInfo_Init(attributeInfo);
-		AttrInfo_AddLoader(attributeInfo, 0, GPU_FLOAT, 3); //First float array = vertex position.
-		AttrInfo_AddLoader(attributeInfo, 1, GPU_FLOAT, 2); //Second float array = texture coordinates.
-		AttrInfo_AddLoader(attributeInfo, 2, GPU_FLOAT, 3); //Third float array = normals.
+		//Meshes are stored as PackedVertex, see common.h.
+		AttrInfo_AddLoader(attributeInfo, 0, GPU_SHORT, 3); //First short array = vertex position.
+		AttrInfo_AddLoader(attributeInfo, 1, GPU_SHORT, 2); //Second short array = texture coordinates.
+		AttrInfo_AddLoader(attributeInfo, 2, GPU_BYTE, 3); //Third byte array = normals.
 
 		// Configure the first fragment shading substage to blend the fragment primary color
 		// with the fragment secondary color.
@@ -74,86 +89,218 @@ namespace Engine {
 		C3D_LightColor(&this->light, 1.0, 1.0, 1.0);
 		C3D_LightPosition(&this->light, &lightVector);
 
+		//GPU buffers come from the linear allocator's pools and frame arena, see linearallocator.h.
+		LinearAllocator::Instance().Initialize();
+
+		//Per-object loops are split across the spare cores, if there are any.
+		JobSystem::Instance().Initialize();
+
 		this->LoadObjects();
+		this->SyncTransforms();
+		this->lastTick = svcGetSystemTick();
 	}
 
 	void Core::LoadObjects(){
 		std::cout << "Loading objects..." << std::endl;
 
+		//A scene in the romfs replaces the built in one. Without one, LoadScene() fails quietly, and the cubes below are made.
+		std::string scenePath = std::string(AssetRoot) + "start.scene";
+		if (this->LoadScene(scenePath.c_str())){
+			return;
+		}
+
 		//This is how you load game objects with customized components.
 		//You first declare a component, with your edited values.
 		//Then you add them in via the helper function, AddComponent<T>(), passing in components as arguments.
 		//This can be extended to full class object initializations.
+		//The cube comes from the romfs, or from the built in vertex list if the romfs does not have it.
+		Handle cube = MeshRegistry::Instance().Load("cube.mesh");
+		if (cube == InvalidHandle){
+			cube = MeshRegistry::Instance().Acquire(vertexList, vertexListSize);
+		}
+
 		for (int i = 0; i < 3; i++){
-			std::shared_ptr<GameObject> temp(new GameObject(vertexList, vertexListSize));
+			GameObject* temp = this->GetGameObject(this->CreateObject(cube));
 			
 			//Physics Component initial setup.
 			PhysicsComponent p;
 			temp->AddComponent<PhysicsComponent>(p);
 			
-			//Transform Component initial setup.
-			//Not sure what to do with Transform Component.
+			//Transform Component initial setup. Resets the scale and rotation.
 			TransformComponent t;
 			temp->AddComponent<TransformComponent>(t);
 			
 			//Setting up the initial positions for each game object.
-			temp->position.x = 3.0f * i;
-			temp->position.y = 5.0f * (i+1);
+			temp->Position().x = 3.0f * i;
+			temp->Position().y = 5.0f * (i+1);
 			
-			//Debugging
+			//Debugging. The debug object floats in front of the camera, at a quarter of its size.
 			if (i == 1){
 				temp->debugFlag = true;
+				this->AttachToCamera(temp);
+				temp->Scale() = FVec3_New(0.25f, 0.25f, 0.25f);
 			}
-			
-			this->gameObjects.push_back(temp);
+
 		}
+
+		//The game objects hold their own references now.
+		MeshRegistry::Instance().Release(cube);
 	}
 
 	void Core::Update(u32 downKey, u32 heldKey, u32 upKey, touchPosition touch){
+		this->Update(downKey, heldKey, upKey, touch, this->MeasureFrameTime());
+	}
+
+	float Core::MeasureFrameTime(){
+		//Measure the time since the last update, in seconds.
+		u64 tick = svcGetSystemTick();
+		float deltaTime = (float) (tick - this->lastTick) / (float) SYSCLOCK_ARM11;
+		this->lastTick = tick;
+		return deltaTime;
+	}
+
+	void Core::Update(u32 downKey, u32 heldKey, u32 upKey, touchPosition touch, float deltaTime){
+		PROFILE_SCOPE(Update);
+
 		//Update the player.
 		this->player.Update(downKey, heldKey, upKey, touch);
 		
-		if (this->player.cameraManipulateFlag){
-			std::shared_ptr<GameObject> closestObject = this->GetClosestObjectToPosition(this->player.cameraPosition, 4.0f); 
-			if (closestObject != nullptr){
-				this->player.inHands = closestObject;
-				this->player.inHands->isPickedUp = true;
+		//Pick up the first object the camera is looking at, unless the hands are full. The ray goes out from where the last
+		//frame was drawn from, so it picks what is on the screen.
+		if (this->player.cameraManipulateFlag && this->player.inHands == InvalidHandle){
+			C3D_FVec origin = Extract_CamPos(&this->inverseViewMatrix);
+			C3D_FVec forward = Extract_CamForward(&this->inverseViewMatrix);
+			BoundingVolumeHierarchy::Hit hit = this->RayCastObjects(origin, forward, this->PickDistance);
+			if (hit.object != InvalidHandle){
+				this->player.inHands = hit.object;
+				this->GetGameObject(hit.object)->isPickedUp = true;
+
+				//Wake it, and whatever was resting on it, before it is taken away.
+				ComponentPools& pools = ComponentPools::Instance();
+				pools.physics.Wake(pools.Find<PhysicsComponent>(hit.object));
+				this->AttachToCamera(this->GetGameObject(hit.object));
+				HUD_PRINT(PickedObject, "Picked object at %.2f", hit.distance);
+			}
+			else {
+				HUD_PRINT(PickedObject, "Picked object? False");
 			}
-			text(20, 0, "                              ");
-			std::cout << "Closest object? " << (closestObject != nullptr ? "True" : "False") << std::endl;
 		}
 		
 
+		//This handles updating the game objects' physics, in sweeps over the physics pool per fixed step. Collisions between
+		//the bodies, and with the player, are resolved on the new velocities, before they move the bodies. Each step first
+		//saves the current transforms, so rendering can interpolate between the last two steps.
+		ComponentPools& pools = ComponentPools::Instance();
+		JobSystem& jobs = JobSystem::Instance();
+		this->physicsAccumulator += deltaTime;
+		u32 steps = 0;
+		{
+			PROFILE_SCOPE(Physics);
+			while (this->physicsAccumulator >= this->physicsStep){
+				if (steps == this->maxPhysicsSteps){
+					//Too far behind to catch up. Drop the backlog, so the simulation slows down instead of spiralling.
+					this->physicsAccumulator = std::fmod(this->physicsAccumulator, this->physicsStep);
+					break;
+				}
+				pools.transforms.SaveState();
+				jobs.ParallelFor(pools.physics.Size(), this->PhysicsGrain, [&](u32 begin, u32 end){
+					pools.physics.Accelerate(pools.transforms, begin, end);
+				});
+				this->collisions.Update(pools.physics, pools.transforms, this->physicsStep);
+				this->collisions.CollideSphere(pools.physics, pools.transforms, this->player.cameraPosition, this->PlayerRadius);
+				jobs.ParallelFor(pools.physics.Size(), this->PhysicsGrain, [&](u32 begin, u32 end){
+					pools.physics.Integrate(pools.transforms, begin, end);
+				});
+				this->physicsAccumulator -= this->physicsStep;
+				steps++;
+			}
+		}
+		this->interpolationAlpha = this->physicsAccumulator / this->physicsStep;
+
+		//Move the physics bodies' pick tree bounds along. The bounds are worked out in parallel, then only bodies that left
+		//their leaf's box touch the tree, one at a time. Bodies that did not move since the last frame, like sleeping ones,
+		//are skipped.
+		if (steps > 0){
+			PROFILE_SCOPE(Bounds);
+			const std::vector<Handle>& owners = pools.physics.owner;
+			this->treeMoves.resize(owners.size());
+			this->treeMinimums.resize(owners.size());
+			this->treeMaximums.resize(owners.size());
+			jobs.ParallelFor((u32) owners.size(), this->BoundsGrain, [&](u32 begin, u32 end){
+				for (u32 i = begin; i < end; i++){
+					u32 slot = HandleTable::IndexOf(owners[i]);
+					const GameObject* object = this->GetGameObject(owners[i]);
+					bool dirty = (pools.transforms.flags[slot] & TransformPool::Dirty) != 0;
+					this->treeMoves[i] = false;
+					if (dirty && object && pools.transforms.parent[slot] == InvalidHandle){
+						this->ObjectBounds(object, this->treeMinimums[i], this->treeMaximums[i]);
+						this->treeMoves[i] = !this->pickTree.Fits(owners[i], this->treeMinimums[i], this->treeMaximums[i]);
+					}
+				}
+			});
+			for (size_t i = 0; i < owners.size(); i++){
+				if (this->treeMoves[i]){
+					C3D_FVec displacement = FVec3_New(pools.physics.vx[i], pools.physics.vy[i], pools.physics.vz[i]);
+					this->pickTree.Update(owners[i], this->treeMinimums[i], this->treeMaximums[i], FVec3_Scale(displacement, this->PickLookahead));
+				}
+			}
+		}
+
 		for (size_t i = 0; i < this->gameObjects.size(); i++){
-			//This handles updating the game object's properties.
-			this->gameObjects[i]->Update();
-			
 			//This checks if the player is picking up the object within a set distance of 5 units away from the player. Else, we
 			//leave it alone.
 			if (!this->player.cameraManipulateFlag && this->gameObjects[i]->isPickedUp){
 				this->gameObjects[i]->isPickedUp = false;
-				this->player.inHands = nullptr;
+				this->player.inHands = InvalidHandle;
+				this->DetachFromCamera(this->gameObjects[i].get());
 			}
 		}
 	}
 
 	void Core::Render(){
 		//Fetch Stereoscopic 3D level.
-		float slider = osGet3DSliderState();
+		this->Render(osGet3DSliderState());
+	}
+
+	void Core::Render(float slider){
 		//Inter Ocular Distance. We divide by 3.0f to reduce the 3D stereoscopic effects.
 		float iod = slider / 3.0f;
 
-		//Rendering scene
-		C3D_FrameBegin(C3D_FRAME_SYNCDRAW);
+		//Last time's transient GPU data is only dropped now, after the frame that used it was synced.
+		LinearAllocator::Instance().BeginFrame();
+
+		//Everything but the projection is the same for both eyes, so it is worked out once for the whole frame.
 		{
+			PROFILE_SCOPE(Prepare);
+			this->PrepareFrame(iod);
+		}
+
+		//Rendering scene. Sync covers waiting on the GPU in C3D_FrameBegin(), and handing the frame over in C3D_FrameEnd().
+		{
+			PROFILE_SCOPE(Sync);
+			C3D_FrameBegin(this->frameSync ? C3D_FRAME_SYNCDRAW : 0);
+		}
+		{
+			PROFILE_SCOPE(Submit);
+
+			//Uniforms keep their values between render targets, so the view only has to go up once.
+			C3D_FVUnifMtx4x4(GPU_VERTEX_SHADER, this->uLoc_view, &this->viewMatrix);
+
 			C3D_FrameDrawOn(this->leftTarget);
-			this->SceneRender(-iod);
+			this->SubmitEye(0);
 			if (iod > 0.0f) {
 				C3D_FrameDrawOn(this->rightTarget);
-				this->SceneRender(iod);
+				this->SubmitEye(1);
 			}
 		}
-		C3D_FrameEnd(0);
+		{
+			PROFILE_SCOPE(Sync);
+			C3D_FrameEnd(0);
+		}
+
+		//Debug text goes out after the frame is submitted, and only if it changed.
+		Profiler::Instance().EndFrame();
+		HUD_DRAW();
 	}
 
 	void Core::Release(){
@@ -161,38 +308,194 @@ namespace Engine {
 		for (size_t i = 0; i < this->gameObjects.size(); i++){
 			this->gameObjects[i]->Release();
 		}
+		this->gameObjects.clear();
+		this->pickTree.Clear();
+		this->player.inHands = InvalidHandle;
+
+		//The meshes went with the last game objects, so the linear heap can have its pages back.
+		LinearAllocator::Instance().Release();
+		JobSystem::Instance().Release();
 	}
 
-	void Core::SceneRender(float interOcularDistance){
+	void Core::PrepareFrame(float interOcularDistance){
+		//Compute projection matrices. The left eye is moved by the negative distance.
+		Mtx_PerspStereoTilt(&this->projectionMatrix[0], this->FieldOfView, this->AspectRatio, this->NearPlane, this->FarPlane, -interOcularDistance, this->ScreenDistance, false);
+		Mtx_PerspStereoTilt(&this->projectionMatrix[1], this->FieldOfView, this->AspectRatio, this->NearPlane, this->FarPlane, interOcularDistance, this->ScreenDistance, false);
+
+		//Compute view matrix, which also moves the camera node, then bring the world matrices up to date.
+		//The camera node's world matrix is the inverse of the view matrix, so there is no need to invert it.
+		TransformPool& transforms = ComponentPools::Instance().transforms;
+		this->player.RenderUpdate(&this->viewMatrix);
+		{
+			PROFILE_SCOPE(Transforms);
+			JobSystem::Instance().ParallelFor(transforms.Size(), this->TransformGrain, [&](u32 begin, u32 end){
+				transforms.UpdateWorldMatrices(this->interpolationAlpha, begin, end);
+			});
+		}
+		this->inverseViewMatrix = transforms.world[HandleTable::IndexOf(this->player.cameraNode)];
+
+		//Find out what is visible through it.
+		{
+			PROFILE_SCOPE(Cull);
+			this->frustum.Set(this->viewMatrix, this->FieldOfView, this->AspectRatio, this->NearPlane, this->FarPlane, interOcularDistance, this->ScreenDistance);
+			this->CullObjects();
+		}
+
+		PROFILE_SCOPE(Queue);
+
+		//Distance in front of the camera, along the view matrix's Z row, and straight distance from the camera, for every
+		//visible object at once. Detail levels go by the straight distance, so objects don't change level just by turning.
+		u32 visibleCount = (u32) this->visibleObjects.size();
+		this->visibleDepths.resize(visibleCount);
+		this->visibleDistances.resize(visibleCount);
+		BatchMath::PlaneDistances(this->visibleDepths.data(), this->visiblePositions.data(), visibleCount, FVec4_Negate(this->viewMatrix.r[2]));
+		BatchMath::Distances(this->visibleDistances.data(), this->visiblePositions.data(), visibleCount, Extract_CamPos(&this->inverseViewMatrix));
+		MeshRegistry& meshes = MeshRegistry::Instance();
+		this->reducedObjects = 0;
+
 		//Declaring reusable model matrix.
 		C3D_Mtx modelMatrix;
-	
-		//Compute projection matrix and update matrix to shader program.                                                                                                               
-		Mtx_PerspStereoTilt(&this->projectionMatrix, 40.0f * (std::acos(-1) / 180.0f), 400.0f / 240.0f, 0.01f, 1000.0f, interOcularDistance, 2.0f, false);
-		C3D_FVUnifMtx4x4(GPU_VERTEX_SHADER, this->uLoc_projection, &this->projectionMatrix);
-	
-		//Do something about view matrix.
-		this->player.RenderUpdate(&this->viewMatrix);
-	
-		//Compute view matrix and update matrix to shader program.
-		C3D_FVUnifMtx4x4(GPU_VERTEX_SHADER, this->uLoc_view, &this->viewMatrix);
-	
-		//Draw the vertex buffer objects.                     
-		for (size_t i = 0; i < this->gameObjects.size(); i++) {
-			//Calculate model view matrix.
-			Mtx_Identity(&modelMatrix);
 
-			//Switch game object buffers
-			this->gameObjects[i]->ConfigureBuffer();
-	
-			//At the moment, there's only 1 object in the scene. This allows the player to "pick" up the object(s) in hand, and manipulate them.
-			this->gameObjects[i]->RenderUpdate(this->player.cameraPosition, this->viewMatrix, &modelMatrix);				
-				
-			//Update to shader program.
-			C3D_FVUnifMtx4x4(GPU_VERTEX_SHADER, this->uLoc_model, &modelMatrix);
-	
-			//Render entity.
-			this->gameObjects[i]->Render();
+		//Queue up the vertex buffer objects, so they can be drawn sorted by mesh.
+		this->renderQueue.Clear();
+		for (size_t v = 0; v < this->visibleObjects.size(); v++) {
+			u32 i = this->visibleObjects[v];
+			GameObject* object = this->gameObjects[i].get();
+
+			//Pick the detail level from how much of the screen the object covers. Both eyes draw the same level, so the
+			//two images never disagree.
+			float distance = std::max(this->visibleDistances[v], this->NearPlane);
+			float screenSize = this->visibleRadii[v] * this->ScreenSizeScale / distance;
+			object->SetDetailLevel(meshes.SelectDetailLevel(object->mesh, screenSize, object->detailLevel));
+			if (object->detailLevel > 0){
+				this->reducedObjects++;
+			}
+
+			//Fetch model matrix.
+			object->RenderUpdate(&modelMatrix);
+			this->renderQueue.Add(object, 0, 0, this->visibleDepths[v], modelMatrix);
+		}
+		this->renderQueue.Sort();
+	}
+
+	void Core::SubmitEye(u32 eye){
+		//Swap in the eye's projection, and replay the frame's draws.
+		C3D_FVUnifMtx4x4(GPU_VERTEX_SHADER, this->uLoc_projection, &this->projectionMatrix[eye]);
+		this->renderQueue.Submit(this->uLoc_model);
+		Profiler::Instance().AddDraws(this->renderQueue.Size(), this->renderQueue.Vertices());
+	}
+
+	void Core::ObjectBounds(const GameObject* object, C3D_FVec& minimum, C3D_FVec& maximum) const {
+		const TransformPool& transforms = ComponentPools::Instance().transforms;
+		C3D_FVec position = transforms.position[object->id];
+		const Mesh* mesh = MeshRegistry::Instance().Get(object->mesh);
+		if (!mesh){
+			minimum = maximum = position;
+			return;
+		}
+
+		//The mesh's box, scaled, then turned. A turned box's bounds reach as far along each world axis as the box's
+		//half sizes along its own axes, projected onto it.
+		C3D_FVec scale = transforms.scale[object->id];
+		C3D_FVec center = FVec3_New(mesh->center.x * scale.x, mesh->center.y * scale.y, mesh->center.z * scale.z);
+		C3D_FVec half = FVec3_New(
+			std::abs(0.5f * (mesh->maximum.x - mesh->minimum.x) * scale.x),
+			std::abs(0.5f * (mesh->maximum.y - mesh->minimum.y) * scale.y),
+			std::abs(0.5f * (mesh->maximum.z - mesh->minimum.z) * scale.z));
+		C3D_Mtx rotation;
+		Mtx_FromQuat(&rotation, transforms.rotation[object->id]);
+
+		float worldCenter[3], reach[3];
+		for (int row = 0; row < 3; row++){
+			const C3D_FVec& axis = rotation.r[row];
+			worldCenter[row] = axis.x * center.x + axis.y * center.y + axis.z * center.z;
+			reach[row] = std::abs(axis.x) * half.x + std::abs(axis.y) * half.y + std::abs(axis.z) * half.z;
+		}
+		minimum = FVec4_New(position.x + worldCenter[0] - reach[0], position.y + worldCenter[1] - reach[1], position.z + worldCenter[2] - reach[2], 1.0f);
+		maximum = FVec4_New(position.x + worldCenter[0] + reach[0], position.y + worldCenter[1] + reach[1], position.z + worldCenter[2] + reach[2], 1.0f);
+	}
+
+	void Core::CullObjects(){
+		TransformPool& transforms = ComponentPools::Instance().transforms;
+		MeshRegistry& meshes = MeshRegistry::Instance();
+
+		this->visibleObjects.clear();
+		this->visiblePositions.clear();
+		this->visibleRadii.clear();
+		this->culledObjects = 0;
+		for (size_t i = 0; i < this->gameObjects.size(); i++){
+			GameObject* object = this->gameObjects[i].get();
+			if (!object->renderFlag){
+				continue;
+			}
+
+			C3D_FVec position = transforms.WorldPosition(object->id);
+			const Mesh* mesh = meshes.Get(object->mesh);
+			float reach = 0.0f;
+			if (mesh){
+				//Test where the object will be drawn. The sphere is grown to cover the mesh at any rotation, and
+				//scaled by the longest axis of the world matrix, so the test needs only the translation.
+				const C3D_Mtx& world = transforms.world[object->id];
+				float scaleX = world.r[0].x * world.r[0].x + world.r[1].x * world.r[1].x + world.r[2].x * world.r[2].x;
+				float scaleY = world.r[0].y * world.r[0].y + world.r[1].y * world.r[1].y + world.r[2].y * world.r[2].y;
+				float scaleZ = world.r[0].z * world.r[0].z + world.r[1].z * world.r[1].z + world.r[2].z * world.r[2].z;
+				float scaleSquared = std::max(scaleX, std::max(scaleY, scaleZ));
+				reach = (FVec3_Magnitude(mesh->center) + mesh->radius) * std::sqrt(scaleSquared);
+				if (!this->frustum.IntersectsSphere(position, reach)){
+					this->culledObjects++;
+					continue;
+				}
+			}
+			this->visibleObjects.push_back((u32) i);
+			this->visiblePositions.push_back(position);
+			this->visibleRadii.push_back(reach);
+		}
+		this->drawnObjects = (u32) this->visibleObjects.size();
+	}
+
+	void Core::AttachToCamera(GameObject* object){
+		//Three units in front of the camera, facing it.
+		TransformPool& transforms = ComponentPools::Instance().transforms;
+		transforms.SetParent(object->handle, this->player.cameraNode);
+		transforms.Place(object->id, FVec4_New(0.0f, 0.0f, -3.0f, 1.0f), Quat_Identity());
+	}
+
+	void Core::DetachFromCamera(GameObject* object){
+		//Leave the object where it was last drawn, turned the way the camera was facing.
+		TransformPool& transforms = ComponentPools::Instance().transforms;
+		C3D_FVec position = transforms.WorldPosition(object->id);
+		C3D_FQuat rotation = Quat_Multiply(transforms.rotation[HandleTable::IndexOf(this->player.cameraNode)], transforms.rotation[object->id]);
+		transforms.SetParent(object->handle, InvalidHandle);
+		transforms.Place(object->id, position, rotation);
+
+		//Its box in the pick tree is wherever it was picked up, so bring that along too.
+		C3D_FVec minimum, maximum;
+		this->ObjectBounds(object, minimum, maximum);
+		this->pickTree.Update(object->handle, minimum, maximum);
+	}
+
+	void Core::SetFrameSync(bool enabled){
+		this->frameSync = enabled;
+	}
+
+	void Core::SetPhysicsRate(float hertz, u32 maxSteps){
+		this->physicsStep = 1.0f / hertz;
+		this->maxPhysicsSteps = maxSteps;
+		this->physicsAccumulator = 0.0f;
+		ComponentPools::Instance().physics.SetStepLength(this->physicsStep);
+	}
+
+	void Core::SyncTransforms(){
+		ComponentPools& pools = ComponentPools::Instance();
+		pools.transforms.SaveState();
+		this->interpolationAlpha = 0.0f;
+		C3D_FVec minimum, maximum;
+		for (size_t i = 0; i < this->gameObjects.size(); i++){
+			GameObject* object = this->gameObjects[i].get();
+			if (pools.transforms.parent[object->id] == InvalidHandle){
+				this->ObjectBounds(object, minimum, maximum);
+				this->pickTree.Update(object->handle, minimum, maximum);
+			}
 		}
 	}
 
@@ -204,24 +507,378 @@ namespace Engine {
 		DVLB_Free(this->vertexShader_dvlb);
 	}
 	
-	//------------------------------------------   Helper functions   ------------------------------------------
+	//------------------------------------------   Game objects   ------------------------------------------
+
+	Handle Core::CreateObject(const Vertex list[], int size){
+		return this->AddObject(new GameObject(list, size));
+	}
+
+	Handle Core::CreateObject(Handle mesh){
+		return this->AddObject(new GameObject(mesh));
+	}
+
+	Handle Core::AddObject(GameObject* object){
+		ComponentPools::Instance().objects.Set(object->handle, (u32) this->gameObjects.size());
+		this->gameObjects.emplace_back(object);
+		C3D_FVec minimum, maximum;
+		this->ObjectBounds(object, minimum, maximum);
+		this->pickTree.Insert(object->handle, minimum, maximum);
+		return object->handle;
+	}
+
+	void Core::DestroyObject(Handle object){
+		u32 index = ComponentPools::Instance().objects.Get(object);
+		if (index == HandleTable::InvalidValue){
+			return;
+		}
+		if (this->player.inHands == object){
+			this->player.inHands = InvalidHandle;
+		}
+
+		//Releasing frees the handle, so any copies of it stop validating from here on.
+		this->pickTree.Remove(object);
+		this->gameObjects[index]->Release();
+
+		//Keep the list dense by moving the last game object into the hole.
+		if (index + 1 != this->gameObjects.size()){
+			this->gameObjects[index] = std::move(this->gameObjects.back());
+			ComponentPools::Instance().objects.Set(this->gameObjects[index]->handle, index);
+		}
+		this->gameObjects.pop_back();
+	}
+
+	GameObject* Core::GetGameObject(Handle object){
+		u32 index = ComponentPools::Instance().objects.Get(object);
+		return index != HandleTable::InvalidValue ? this->gameObjects[index].get() : nullptr;
+	}
 	
-	std::shared_ptr<GameObject> Core::GetClosestObjectToPosition(C3D_FVec targetPosition, float maximumDistance){
-		std::shared_ptr<GameObject> result = nullptr;
-		//Setting the minimum distance value as the maximum distance value for accuracy.
-		float minimumDistance = maximumDistance; 
-		for (size_t i = 0; i < this->gameObjects.size(); i++){
-			if (this->gameObjects[i]->debugFlag){
-				//We skip game objects marked as debug objects. We don't want it to affect our calculations.
-				continue;
+	//------------------------------------------   Scenes   ------------------------------------------
+
+	//Reads the blob into count elements at data. The size was checked against the file by IsCompatibleSceneFile().
+	static bool ReadSceneBlob(FILE* file, const SceneFileHeader& header, SceneBlob blob, void* data){
+		u32 bytes = SceneBlobCountOf(header, blob) * SceneBlobElementSize(blob);
+		return bytes == 0 || (std::fseek(file, header.offsets[(u32) blob], SEEK_SET) == 0 && std::fread(data, 1, bytes, file) == bytes);
+	}
+
+	//Pads the file up to the blob's offset, then writes it.
+	static bool WriteSceneBlob(FILE* file, const SceneFileHeader& header, SceneBlob blob, const void* data){
+		static const u8 padding[SceneFileAlignment] = { 0 };
+		long position = std::ftell(file);
+		if (position < 0 || (u32) position > header.offsets[(u32) blob]){
+			return false;
+		}
+		u32 gap = header.offsets[(u32) blob] - (u32) position;
+		u32 bytes = SceneBlobCountOf(header, blob) * SceneBlobElementSize(blob);
+		return std::fwrite(padding, 1, gap, file) == gap && (bytes == 0 || std::fwrite(data, 1, bytes, file) == bytes);
+	}
+
+	bool Core::LoadScene(const char* path){
+		//A missing file is left for the caller to report, since LoadObjects() tries one on every start.
+		FILE* file = std::fopen(path, "rb");
+		if (!file){
+			if (errno != ENOENT){
+				std::cout << "Cannot open scene " << path << std::endl;
 			}
-			float checkDistance = FVec4_Magnitude(FVec4_Subtract(this->gameObjects[i]->position, targetPosition));
-			//It is rare for floating numbers to be equal to the other, but we put it there for math accuracy.
-			if (checkDistance <= maximumDistance && checkDistance < minimumDistance){
-				result = this->gameObjects[i];
-				minimumDistance = checkDistance;
+			return false;
+		}
+		long fileSize = std::fseek(file, 0, SEEK_END) == 0 ? std::ftell(file) : -1;
+		SceneFileHeader header;
+		if (fileSize < 0 || std::fseek(file, 0, SEEK_SET) != 0 || std::fread(&header, sizeof(header), 1, file) != 1 ||
+			!IsCompatibleSceneFile(header, (u32) fileSize)){
+			std::cout << "Not a usable scene file: " << path << std::endl;
+			std::fclose(file);
+			return false;
+		}
+
+		//The whole file is read, and checked, before anything in the world changes, so a broken file leaves it as it was.
+		std::vector<SceneMeshRecord> meshRecords(header.meshCount);
+		std::vector<SceneObjectRecord> objectRecords(header.objectCount);
+		std::vector<C3D_FVec> positions(header.objectCount);
+		std::vector<C3D_FQuat> rotations(header.objectCount);
+		std::vector<C3D_FVec> scales(header.objectCount);
+		std::vector<u32> bodyOwners(header.bodyCount);
+		std::vector<u32> islands(header.bodyCount);
+		std::vector<float> ax(header.bodyCount), ay(header.bodyCount), az(header.bodyCount);
+		std::vector<float> vx(header.bodyCount), vy(header.bodyCount), vz(header.bodyCount);
+		std::vector<C3D_FVec> halfExtents(header.bodyCount);
+		std::vector<float> restTimes(header.bodyCount);
+		std::vector<u8> asleep(header.bodyCount);
+		bool valid = ReadSceneBlob(file, header, SceneBlob::Meshes, meshRecords.data()) &&
+			ReadSceneBlob(file, header, SceneBlob::Objects, objectRecords.data()) &&
+			ReadSceneBlob(file, header, SceneBlob::Positions, positions.data()) &&
+			ReadSceneBlob(file, header, SceneBlob::Rotations, rotations.data()) &&
+			ReadSceneBlob(file, header, SceneBlob::Scales, scales.data()) &&
+			ReadSceneBlob(file, header, SceneBlob::BodyOwners, bodyOwners.data()) &&
+			ReadSceneBlob(file, header, SceneBlob::AccelerationsX, ax.data()) &&
+			ReadSceneBlob(file, header, SceneBlob::AccelerationsY, ay.data()) &&
+			ReadSceneBlob(file, header, SceneBlob::AccelerationsZ, az.data()) &&
+			ReadSceneBlob(file, header, SceneBlob::VelocitiesX, vx.data()) &&
+			ReadSceneBlob(file, header, SceneBlob::VelocitiesY, vy.data()) &&
+			ReadSceneBlob(file, header, SceneBlob::VelocitiesZ, vz.data()) &&
+			ReadSceneBlob(file, header, SceneBlob::HalfExtents, halfExtents.data()) &&
+			ReadSceneBlob(file, header, SceneBlob::RestTimes, restTimes.data()) &&
+			ReadSceneBlob(file, header, SceneBlob::Asleep, asleep.data()) &&
+			ReadSceneBlob(file, header, SceneBlob::Islands, islands.data());
+		std::fclose(file);
+
+		for (u32 i = 0; valid && i < header.objectCount; i++){
+			const SceneObjectRecord& record = objectRecords[i];
+			valid = (record.mesh < header.meshCount || record.mesh == SceneNone) &&
+				(record.parent < header.objectCount || record.parent == SceneNone || record.parent == SceneCamera);
+		}
+		//Every chain of parents has to end at the world or the camera, or SetParent() would refuse a link of it. Each
+		//chain is followed up to the first object already known to be fine, so every object is visited about once.
+		std::vector<u8> rooted(header.objectCount, 0);
+		std::vector<u8> onChain(header.objectCount, 0);
+		std::vector<u32> chain;
+		for (u32 i = 0; valid && i < header.objectCount; i++){
+			chain.clear();
+			u32 object = i;
+			while (object < header.objectCount && !rooted[object] && !onChain[object]){
+				onChain[object] = 1;
+				chain.push_back(object);
+				object = objectRecords[object].parent;
+			}
+			valid = object >= header.objectCount || rooted[object];
+			for (size_t k = 0; k < chain.size(); k++){
+				rooted[chain[k]] = 1;
+			}
+		}
+		//Every game object has at most one body.
+		std::vector<u8> hasBody(header.objectCount, 0);
+		for (u32 i = 0; valid && i < header.bodyCount; i++){
+			valid = bodyOwners[i] < header.objectCount && !hasBody[bodyOwners[i]] && (islands[i] < header.bodyCount || islands[i] == SceneNone);
+			if (valid){
+				hasBody[bodyOwners[i]] = 1;
 			}
 		}
-		return result;
+		//A sleeping body's island is named after a body that sleeps in it too, the way SaveScene() writes them, or the
+		//islands' rings would get tangled. See PhysicsPool::Sleep().
+		for (u32 i = 0; valid && i < header.bodyCount; i++){
+			u32 named = islands[i];
+			valid = !asleep[i] || named == SceneNone || (asleep[named] && islands[named] == named);
+		}
+		for (u32 i = 0; valid && i < header.meshCount; i++){
+			valid = std::memchr(meshRecords[i].asset, 0, sizeof(meshRecords[i].asset)) != nullptr;
+		}
+		if (!valid){
+			std::cout << "Broken scene file: " << path << std::endl;
+			return false;
+		}
+
+		//The meshes, holding a reference each until the game objects have theirs.
+		MeshRegistry& registry = MeshRegistry::Instance();
+		std::vector<Handle> meshes(header.meshCount, InvalidHandle);
+		for (u32 i = 0; i < header.meshCount; i++){
+			if (meshRecords[i].flags & SceneMeshBuiltIn){
+				meshes[i] = registry.Acquire(vertexList, vertexListSize);
+			}
+			else {
+				meshes[i] = registry.Load(meshRecords[i].asset);
+			}
+			if (meshes[i] == InvalidHandle){
+				valid = false;
+				break;
+			}
+		}
+		if (!valid){
+			std::cout << "Cannot load the meshes of scene " << path << std::endl;
+			for (u32 i = 0; i < header.meshCount; i++){
+				registry.Release(meshes[i]);
+			}
+			return false;
+		}
+
+		//Out with the old world.
+		while (!this->gameObjects.empty()){
+			this->DestroyObject(this->gameObjects.back()->handle);
+		}
+		this->player.inHands = InvalidHandle;
+		ComponentPools& pools = ComponentPools::Instance();
+		TransformPool& transforms = pools.transforms;
+		this->gameObjects.reserve(header.objectCount);
+		pools.Reserve(header.objectCount, header.bodyCount);
+
+		//Transforms go to wherever their game object's slot is, so they are placed one at a time, before the game objects
+		//go into the pick tree.
+		std::vector<Handle> objects(header.objectCount);
+		for (u32 i = 0; i < header.objectCount; i++){
+			const SceneObjectRecord& record = objectRecords[i];
+			GameObject* object = new GameObject(record.mesh != SceneNone ? meshes[record.mesh] : InvalidHandle);
+			object->renderFlag = (record.flags & SceneObjectRender) != 0;
+			object->updateFlag = (record.flags & SceneObjectUpdate) != 0;
+			object->debugFlag = (record.flags & SceneObjectDebug) != 0;
+			transforms.Place(object->id, positions[i], rotations[i]);
+			transforms.scale[object->id] = scales[i];
+			objects[i] = this->AddObject(object);
+		}
+		for (u32 i = 0; i < header.objectCount; i++){
+			const SceneObjectRecord& record = objectRecords[i];
+			if (record.parent == SceneCamera){
+				transforms.SetParent(objects[i], this->player.cameraNode);
+				//Dropped again on the next Update(), unless the pick button is still held.
+				if (record.flags & SceneObjectPickedUp){
+					this->GetGameObject(objects[i])->isPickedUp = true;
+					this->player.inHands = objects[i];
+				}
+			}
+			else if (record.parent != SceneNone){
+				transforms.SetParent(objects[i], objects[record.parent]);
+			}
+		}
+
+		//The bodies are added all at once, at the end of the pool, and their values copied in an array at a time.
+		std::vector<Handle> owners(header.bodyCount);
+		for (u32 i = 0; i < header.bodyCount; i++){
+			owners[i] = objects[bodyOwners[i]];
+		}
+		PhysicsPool& physics = pools.physics;
+		u32 first = pools.AttachBodies(owners.data(), header.bodyCount);
+		std::copy(ax.begin(), ax.end(), physics.ax.begin() + first);
+		std::copy(ay.begin(), ay.end(), physics.ay.begin() + first);
+		std::copy(az.begin(), az.end(), physics.az.begin() + first);
+		std::copy(vx.begin(), vx.end(), physics.vx.begin() + first);
+		std::copy(vy.begin(), vy.end(), physics.vy.begin() + first);
+		std::copy(vz.begin(), vz.end(), physics.vz.begin() + first);
+		std::copy(halfExtents.begin(), halfExtents.end(), physics.halfExtents.begin() + first);
+		std::copy(restTimes.begin(), restTimes.end(), physics.restTime.begin() + first);
+
+		//Islands are named after one of their bodies, whose handle is new, and their rings are made again by putting
+		//their bodies back to sleep.
+		for (u32 i = 0; i < header.bodyCount; i++){
+			if (asleep[i] && islands[i] != SceneNone){
+				physics.Sleep(physics.body[first + i], physics.body[first + islands[i]]);
+			}
+			else {
+				physics.asleep[first + i] = asleep[i];
+			}
+		}
+
+		//The game objects hold their own references now.
+		for (u32 i = 0; i < header.meshCount; i++){
+			registry.Release(meshes[i]);
+		}
+
+		//None of the old boxes belong to the new bodies.
+		this->collisions.Reset();
+		this->physicsAccumulator = 0.0f;
+		this->SyncTransforms();
+		return true;
+	}
+
+	bool Core::SaveScene(const char* path){
+		ComponentPools& pools = ComponentPools::Instance();
+		const TransformPool& transforms = pools.transforms;
+		const PhysicsPool& physics = pools.physics;
+		MeshRegistry& registry = MeshRegistry::Instance();
+
+		//Game objects go out in the order they are in gameObjects, and bodies in the order of the pool, so loading a
+		//scene and saving it again writes the same file.
+		SceneFileHeader header;
+		std::memset(&header, 0, sizeof(header));
+		header.objectCount = (u32) this->gameObjects.size();
+		header.bodyCount = physics.Size();
+
+		std::vector<Handle> meshes;
+		std::vector<SceneMeshRecord> meshRecords;
+		std::vector<SceneObjectRecord> objectRecords(header.objectCount);
+		std::vector<C3D_FVec> positions(header.objectCount);
+		std::vector<C3D_FQuat> rotations(header.objectCount);
+		std::vector<C3D_FVec> scales(header.objectCount);
+		for (u32 i = 0; i < header.objectCount; i++){
+			const GameObject* object = this->gameObjects[i].get();
+			SceneObjectRecord& record = objectRecords[i];
+
+			//There are only ever a few meshes, so they are looked up one by one.
+			record.mesh = SceneNone;
+			if (object->mesh != InvalidHandle){
+				record.mesh = (u32) (std::find(meshes.begin(), meshes.end(), object->mesh) - meshes.begin());
+				if (record.mesh == meshes.size()){
+					const Mesh* mesh = registry.Get(object->mesh);
+					SceneMeshRecord meshRecord;
+					std::memset(&meshRecord, 0, sizeof(meshRecord));
+					if (mesh->asset.empty()){
+						meshRecord.flags = SceneMeshBuiltIn;
+					}
+					else if (mesh->asset.size() < sizeof(meshRecord.asset)){
+						std::memcpy(meshRecord.asset, mesh->asset.c_str(), mesh->asset.size());
+					}
+					else {
+						std::cout << "Mesh name too long for a scene file: " << mesh->asset << std::endl;
+						return false;
+					}
+					meshes.push_back(object->mesh);
+					meshRecords.push_back(meshRecord);
+				}
+			}
+
+			Handle parent = transforms.parent[object->id];
+			record.parent = SceneNone;
+			if (parent == this->player.cameraNode){
+				record.parent = SceneCamera;
+			}
+			else if (parent != InvalidHandle){
+				record.parent = pools.objects.Get(parent);
+			}
+			record.flags = (object->renderFlag ? SceneObjectRender : 0) | (object->updateFlag ? SceneObjectUpdate : 0) |
+				(object->debugFlag ? SceneObjectDebug : 0) | (object->isPickedUp ? SceneObjectPickedUp : 0);
+
+			positions[i] = transforms.position[object->id];
+			rotations[i] = transforms.rotation[object->id];
+			scales[i] = transforms.scale[object->id];
+		}
+		header.meshCount = (u32) meshRecords.size();
+
+		//Owners by game object index, and islands by the index of their first body.
+		std::vector<u32> bodyOwners(header.bodyCount);
+		std::vector<u32> islands(header.bodyCount, SceneNone);
+		std::map<Handle, u32> firstBodies;
+		for (u32 i = 0; i < header.bodyCount; i++){
+			bodyOwners[i] = pools.objects.Get(physics.owner[i]);
+			if (physics.island[i] != InvalidHandle){
+				islands[i] = firstBodies.insert(std::make_pair(physics.island[i], i)).first->second;
+			}
+		}
+
+		u32 fileSize = LayOutSceneFile(header);
+		FILE* file = std::fopen(path, "wb");
+		if (!file){
+			std::cout << "Cannot write scene " << path << std::endl;
+			return false;
+		}
+		bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+			WriteSceneBlob(file, header, SceneBlob::Meshes, meshRecords.data()) &&
+			WriteSceneBlob(file, header, SceneBlob::Objects, objectRecords.data()) &&
+			WriteSceneBlob(file, header, SceneBlob::Positions, positions.data()) &&
+			WriteSceneBlob(file, header, SceneBlob::Rotations, rotations.data()) &&
+			WriteSceneBlob(file, header, SceneBlob::Scales, scales.data()) &&
+			WriteSceneBlob(file, header, SceneBlob::BodyOwners, bodyOwners.data()) &&
+			WriteSceneBlob(file, header, SceneBlob::AccelerationsX, physics.ax.data()) &&
+			WriteSceneBlob(file, header, SceneBlob::AccelerationsY, physics.ay.data()) &&
+			WriteSceneBlob(file, header, SceneBlob::AccelerationsZ, physics.az.data()) &&
+			WriteSceneBlob(file, header, SceneBlob::VelocitiesX, physics.vx.data()) &&
+			WriteSceneBlob(file, header, SceneBlob::VelocitiesY, physics.vy.data()) &&
+			WriteSceneBlob(file, header, SceneBlob::VelocitiesZ, physics.vz.data()) &&
+			WriteSceneBlob(file, header, SceneBlob::HalfExtents, physics.halfExtents.data()) &&
+			WriteSceneBlob(file, header, SceneBlob::RestTimes, physics.restTime.data()) &&
+			WriteSceneBlob(file, header, SceneBlob::Asleep, physics.asleep.data()) &&
+			WriteSceneBlob(file, header, SceneBlob::Islands, islands.data()) &&
+			std::ftell(file) == (long) fileSize;
+		written = std::fclose(file) == 0 && written;
+		if (!written){
+			std::cout << "Cannot write scene " << path << std::endl;
+		}
+		return written;
+	}
+
+	//------------------------------------------   Helper functions   ------------------------------------------
+	
+	BoundingVolumeHierarchy::Hit Core::RayCastObjects(C3D_FVec origin, C3D_FVec direction, float maximumDistance){
+		//Only the boxes the ray passes through are searched.
+		return this->pickTree.RayCast(origin, direction, maximumDistance, [this](Handle object){
+			//Debug objects, and objects already in hands, hang in front of the camera, and would always be hit first.
+			GameObject* gameObject = this->GetGameObject(object);
+			return !gameObject->debugFlag && !gameObject->isPickedUp;
+		});
 	}
 };
@@ -6,7 +6,16 @@
 #include "../common.h"
 #include "../entity/entity.h"
 #include "../entity/player.h"
+#include "batchmath.h"
+#include "bvh.h"
+#include "collision.h"
 #include "component.h"
+#include "frustum.h"
+#include "inputlog.h"
+#include "jobs.h"
+#include "profiler.h"
+#include "renderqueue.h"
+#include "scene.h"
 
 //Shader headers
 #include "vshader_shbin.h"
@@ -20,8 +29,10 @@ namespace Engine {
 		int uLoc_model;
 		int uLoc_view;
 
-		C3D_Mtx projectionMatrix;
+		//Left and right eye projections, and the view shared by both. Built by PrepareFrame().
+		C3D_Mtx projectionMatrix[2];
 		C3D_Mtx viewMatrix;
+		C3D_Mtx inverseViewMatrix;
 		C3D_LightEnv lightEnvironment;
 		C3D_Light light;
 		C3D_LightLut lut_Phong;
@@ -33,22 +44,149 @@ namespace Engine {
 
 		Player player;
 
+		//Projection parameters, shared by both eyes.
+		const float FieldOfView = 40.0f * radian;
+		const float AspectRatio = 400.0f / 240.0f;
+		const float NearPlane = 0.01f;
+		const float FarPlane = 1000.0f;
+		const float ScreenDistance = 2.0f;
+
+		//Screen size, as a fraction of the screen height, of a sphere with radius 1 at distance 1. See MeshRegistry::AddDetailLevel().
+		const float ScreenSizeScale = 1.0f / FastMath::Tan(FieldOfView * 0.5f);
+
+		//Built once per frame by PrepareFrame(), wide enough for both eyes. It only draws the game objects
+		//in visibleObjects (indices into gameObjects), so culled objects cost neither eye anything.
+		Frustum frustum;
+		std::vector<u32> visibleObjects;
+
+		//World positions of the visible objects, the radius of their bounding spheres, their depths in front of the camera,
+		//and their distances from it, in the same order.
+		std::vector<C3D_FVec> visiblePositions;
+		std::vector<float> visibleRadii;
+		std::vector<float> visibleDepths;
+		std::vector<float> visibleDistances;
+
+		//Fixed-step physics clock. Update() banks elapsed time in the accumulator and runs whole physics
+		//steps out of it, at most maxPhysicsSteps per update. What is left over becomes the interpolation
+		//factor PrepareFrame() blends the last two physics states with.
+		float physicsStep;
+		u32 maxPhysicsSteps;
+		float physicsAccumulator;
+		float interpolationAlpha;
+		u64 lastTick;
+
+		//Whether Render() waits for the screen to refresh before starting a frame. See SetFrameSync().
+		bool frameSync;
+
+		//Smallest part of each per-object loop worth handing to another core, in objects. See JobSystem.
+		const u32 PhysicsGrain = 256;
+		const u32 BoundsGrain = 256;
+		const u32 TransformGrain = 128;
+
+		//Whether each physics body left its leaf in the pick tree in the last update, and its new bounds, by body index.
+		std::vector<u8> treeMoves;
+		std::vector<C3D_FVec> treeMinimums;
+		std::vector<C3D_FVec> treeMaximums;
+
+		//Steps of its velocity, at PhysicsPool::ReferenceRate, a moving body's box in the pick tree is stretched to cover.
+		const float PickLookahead = 4.0f;
+
+		//How far in front of the camera objects can be picked up.
+		const float PickDistance = 4.0f;
+
+		//The player's body, for pushing physics bodies out of the way. A sphere around the camera.
+		const float PlayerRadius = 0.5f;
+
+		//Takes ownership of a new game object, and registers it with the object table and the pick tree.
+		Handle AddObject(GameObject* object);
+
+		//World space box around the game object's mesh, from its current transform. Only for root transforms.
+		void ObjectBounds(const GameObject* object, C3D_FVec& minimum, C3D_FVec& maximum) const;
+
+		//Fills visibleObjects, visiblePositions and visibleRadii with the game objects inside the frustum.
+		void CullObjects();
+
+		//Hangs the game object in front of the camera, by making it a child of the camera node, and lets go of it again.
+		void AttachToCamera(GameObject* object);
+		void DetachFromCamera(GameObject* object);
+
+		//Rendering is split in two. PrepareFrame() does everything both eyes share: projections, view matrix and its
+		//inverse, world matrices, culling and the sorted render queue. SubmitEye() then only uploads the
+		//eye's projection and submits the queue, so the second eye costs little more than its draw calls.
+		void PrepareFrame(float interOcularDistance);
+		void SubmitEye(u32 eye);
 
 	public:
-		std::vector<std::shared_ptr<GameObject>> gameObjects;
+		//Every live game object, densely packed. The object handle table maps handles to indices in here.
+		std::vector<std::unique_ptr<GameObject>> gameObjects;
+		
+		//Bounding volume hierarchy over the game objects' bounds, for picking them with rays. Kept up to date by Update().
+		BoundingVolumeHierarchy pickTree;
+
+		//Contacts between the physics bodies, found and resolved after every physics step.
+		CollisionWorld collisions;
+
+		//Draws of the current frame, shared by both eyes and sorted by GPU state. Rebuilt by PrepareFrame().
+		RenderQueue renderQueue;
+
+		//Game objects that passed and failed the frustum test in the last Render(), and drawn ones that used a coarser detail level.
+		u32 drawnObjects;
+		u32 culledObjects;
+		u32 reducedObjects;
 
 		static Core& Instance();
+		Core();
 		~Core();
 		void Initialize();
+
+		//Loads romfs/start.scene if there is one, and the built in cubes otherwise.
 		void LoadObjects();
+
+		//Replaces every game object with the ones in the scene file, see scene.h. Reads and checks the whole file, and
+		//loads its meshes, before touching the world, and leaves the world as it was if any of that fails. Nothing can
+		//fail after that, so it returns false only with the world untouched. Says nothing if the file does not exist.
+		bool LoadScene(const char* path);
+
+		//Writes every game object, with its transform and body, to a scene file LoadScene() can restore. The meshes
+		//are written by name, so objects drawing meshes made at runtime come back with the built in vertex list, and
+		//detail levels are left for whoever loads the scene to add again. Returns false on failure.
+		bool SaveScene(const char* path);
+
 		void Update(u32 down, u32 held, u32 up, touchPosition touch);
+		void Update(u32 down, u32 held, u32 up, touchPosition touch, float deltaTime);
 		void Render();
+		//Renders with the given 3D slider level, instead of reading the slider, e.g. when replaying an input log.
+		void Render(float slider);
+
+		//Seconds since the last call. The Update() without a deltaTime uses it, so only call it to pass the result on.
+		float MeasureFrameTime();
+
+		//Turning frame sync off lets frames start as soon as the GPU is done with the last one, instead of waiting for
+		//the screen to refresh. For running input log replays as fast as possible. On by default.
+		void SetFrameSync(bool enabled);
 		void Release();
-		void SceneRender(float interOcularDistance);
 		void SceneExit();
 		
+		//Physics runs at the given rate, independent of the frame rate. Defaults to 60 Hz, with up to 4 catch-up steps per update.
+		void SetPhysicsRate(float hertz, u32 maxSteps);
+		
+		//Makes the interpolated transforms match the current ones, and refreshes the pick tree.
+		//Call after moving objects outside of Update(), e.g. right after spawning them.
+		void SyncTransforms();
+		
+		//Game objects are created and destroyed through Core, and referred to by handles everywhere else.
+		//Objects created from the same vertex list, or from the same mesh handle, share one vertex buffer.
+		Handle CreateObject(const Vertex list[], int size);
+		Handle CreateObject(Handle mesh);
+		void DestroyObject(Handle object);
+		
+		//Returns nullptr if the handle is stale.
+		GameObject* GetGameObject(Handle object);
+		
 		//Helper functions
-		std::shared_ptr<GameObject> GetClosestObjectToPosition(C3D_FVec targetPosition, float maximumDistance);
+
+		//First game object the ray hits within maximumDistance, leaving out debug and held objects.
+		BoundingVolumeHierarchy::Hit RayCastObjects(C3D_FVec origin, C3D_FVec direction, float maximumDistance);
 	};
 };
 
@@ -0,0 +1,50 @@
+#include "frustum.h"
+
+namespace Engine {
+	void Frustum::Set(const C3D_Mtx& viewMatrix, float fieldOfView, float aspectRatio, float near, float far, float interOcularDistance, float screenDistance){
+		//View space, camera looking down -Z, so a point's distance in front of the camera is -z.
+		const float tangentY = FastMath::Tan(fieldOfView * 0.5f);
+		const float tangentX = tangentY * aspectRatio;
+
+		//The stereo projection moves each eye sideways by half the separation, and shears the view so both eyes
+		//line up on the screen plane. That shifts the side planes by half the separation (in clip space, so up to
+		//tangentX times that in view space), and tilts them by at most half the separation over the screen distance.
+		//Widening the side planes by both keeps the view volumes of the two eyes inside. Top and bottom are shared.
+		const float separation = std::abs(interOcularDistance) * 0.5f;
+		const float slopeX = tangentX + separation / screenDistance;
+		const float offsetX = separation * (1.0f + tangentX);
+
+		C3D_FVec viewPlanes[6];
+		viewPlanes[0] = FVec4_New(1.0f, 0.0f, -slopeX, offsetX);
+		viewPlanes[1] = FVec4_New(-1.0f, 0.0f, -slopeX, offsetX);
+		viewPlanes[2] = FVec4_New(0.0f, 1.0f, -tangentY, 0.0f);
+		viewPlanes[3] = FVec4_New(0.0f, -1.0f, -tangentY, 0.0f);
+		viewPlanes[4] = FVec4_New(0.0f, 0.0f, -1.0f, -near);
+		viewPlanes[5] = FVec4_New(0.0f, 0.0f, 1.0f, far);
+
+		for (int i = 0; i < 6; i++){
+			//A view space plane times the view matrix gives the world space plane, since the view matrix is what
+			//takes world space points into view space.
+			const C3D_FVec& p = viewPlanes[i];
+			C3D_FVec plane;
+			plane.x = p.x * viewMatrix.r[0].x + p.y * viewMatrix.r[1].x + p.z * viewMatrix.r[2].x + p.w * viewMatrix.r[3].x;
+			plane.y = p.x * viewMatrix.r[0].y + p.y * viewMatrix.r[1].y + p.z * viewMatrix.r[2].y + p.w * viewMatrix.r[3].y;
+			plane.z = p.x * viewMatrix.r[0].z + p.y * viewMatrix.r[1].z + p.z * viewMatrix.r[2].z + p.w * viewMatrix.r[3].z;
+			plane.w = p.x * viewMatrix.r[0].w + p.y * viewMatrix.r[1].w + p.z * viewMatrix.r[2].w + p.w * viewMatrix.r[3].w;
+
+			//Normalizing, so plane tests give real distances to compare radii against.
+			float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+			this->planes[i] = FVec4_Scale(plane, 1.0f / length);
+		}
+	}
+
+	bool Frustum::IntersectsSphere(C3D_FVec center, float radius) const {
+		for (int i = 0; i < 6; i++){
+			const C3D_FVec& plane = this->planes[i];
+			if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius){
+				return false;
+			}
+		}
+		return true;
+	}
+}
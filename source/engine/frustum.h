@@ -0,0 +1,27 @@
+#pragma once
+
+#ifndef FRUSTUM_HEADER
+#	define FRUSTUM_HEADER
+
+#include "../common.h"
+
+namespace Engine {
+	//The six planes of the camera's view volume, in world space, for throwing away objects that cannot be on screen.
+	//Built straight from the same parameters given to Mtx_PerspStereoTilt(), and wide enough to contain the view
+	//volumes of both eyes, so one frustum and one test per object covers a whole stereo frame.
+	class Frustum {
+	public:
+		//fieldOfView is vertical, in radians. interOcularDistance and screenDistance are the ones the projection uses,
+		//and the sign of the eye separation does not matter.
+		void Set(const C3D_Mtx& viewMatrix, float fieldOfView, float aspectRatio, float near, float far, float interOcularDistance, float screenDistance);
+
+		//True if any part of the sphere may be inside. Spheres straddling a plane count as inside.
+		bool IntersectsSphere(C3D_FVec center, float radius) const;
+
+	private:
+		//Planes are (x, y, z) normal pointing inwards, and w the offset: inside is dot(normal, point) + w >= 0.
+		C3D_FVec planes[6];
+	};
+};
+
+#endif
@@ -0,0 +1,55 @@
+#include "handle.h"
+
+namespace Entity {
+	const u32 HandleTable::IndexBits;
+	const u32 HandleTable::IndexMask;
+	const u32 HandleTable::GenerationMask;
+	const u32 HandleTable::InvalidValue;
+
+	Handle HandleTable::Create(u32 value){
+		u32 index;
+		if (!this->freeSlots.empty()){
+			index = this->freeSlots.back();
+			this->freeSlots.pop_back();
+		}
+		else {
+			index = (u32) this->values.size();
+			this->values.push_back(InvalidValue);
+			this->generations.push_back(1);
+		}
+		this->values[index] = value;
+		return (((u32) this->generations[index]) << IndexBits) | index;
+	}
+
+	void HandleTable::Destroy(Handle handle){
+		if (!this->IsValid(handle)){
+			return;
+		}
+		u32 index = IndexOf(handle);
+		this->values[index] = InvalidValue;
+
+		//Skip generation 0 when wrapping around, so InvalidHandle never becomes valid.
+		u16 generation = (u16) ((this->generations[index] + 1) & GenerationMask);
+		this->generations[index] = generation == 0 ? 1 : generation;
+		this->freeSlots.push_back(index);
+	}
+
+	bool HandleTable::IsValid(Handle handle) const {
+		u32 index = IndexOf(handle);
+		return index < this->generations.size() && this->generations[index] == GenerationOf(handle);
+	}
+
+	u32 HandleTable::Get(Handle handle) const {
+		return this->IsValid(handle) ? this->values[IndexOf(handle)] : InvalidValue;
+	}
+
+	void HandleTable::Set(Handle handle, u32 value){
+		if (this->IsValid(handle)){
+			this->values[IndexOf(handle)] = value;
+		}
+	}
+
+	u32 HandleTable::Capacity() const {
+		return (u32) this->values.size();
+	}
+}
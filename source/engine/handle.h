@@ -0,0 +1,54 @@
+#pragma once
+
+#ifndef HANDLE_HEADER
+#	define HANDLE_HEADER
+
+#include "../common.h"
+
+namespace Entity {
+	//Plain 32-bit reference to a game object or component. The low bits are a slot index into a
+	//HandleTable, the high bits the generation of that slot. Destroying a slot bumps its generation,
+	//so handles still pointing at it stop validating instead of reaching whatever reuses the slot.
+	typedef u32 Handle;
+
+	//Generations start at 1, so 0 is never a valid handle.
+	static const Handle InvalidHandle = 0;
+
+	class HandleTable {
+	public:
+		static const u32 IndexBits = 20;
+		static const u32 IndexMask = (1U << IndexBits) - 1;
+		static const u32 GenerationMask = (1U << (32 - IndexBits)) - 1;
+		static const u32 InvalidValue = 0xFFFFFFFF;
+
+		//Allocates a slot holding the given value, and returns its handle.
+		Handle Create(u32 value);
+
+		//Frees the slot. Does nothing if the handle is stale.
+		void Destroy(Handle handle);
+
+		bool IsValid(Handle handle) const;
+
+		//Returns the value stored for the handle, or InvalidValue if the handle is stale.
+		u32 Get(Handle handle) const;
+		void Set(Handle handle, u32 value);
+
+		//Number of slots ever allocated. Slot indices are always below this.
+		u32 Capacity() const;
+
+		static u32 IndexOf(Handle handle){
+			return handle & IndexMask;
+		}
+
+		static u32 GenerationOf(Handle handle){
+			return handle >> IndexBits;
+		}
+
+	private:
+		std::vector<u32> values;
+		std::vector<u16> generations;
+		std::vector<u32> freeSlots;
+	};
+};
+
+#endif
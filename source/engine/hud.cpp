@@ -0,0 +1,68 @@
+#include "hud.h"
+
+#ifdef HUD_ENABLED
+
+#include <cstdarg>
+
+namespace Engine {
+	//Console row of each slot, in HudSlot order.
+	static const u8 SlotRows[(u32) HudSlot::Count] = { 8, 9, 10, 11, 12, 14, 15, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29 };
+
+	const u32 DebugHud::Columns;
+	const u32 DebugHud::RedrawRate;
+
+	DebugHud& DebugHud::Instance(){
+		static DebugHud hud;
+		return hud;
+	}
+
+	void DebugHud::Print(HudSlot slot, const char* format, ...){
+		char text[Columns + 1];
+		va_list arguments;
+		va_start(arguments, format);
+		std::vsnprintf(text, sizeof(text), format, arguments);
+		va_end(arguments);
+
+		Line& line = this->lines[(u32) slot];
+		if (std::strcmp(line.text, text) != 0){
+			std::memcpy(line.text, text, sizeof(text));
+			line.changed = true;
+		}
+	}
+
+	void DebugHud::Clear(HudSlot slot){
+		Line& line = this->lines[(u32) slot];
+		if (line.text[0] != '\0'){
+			line.text[0] = '\0';
+			line.changed = true;
+		}
+	}
+
+	void DebugHud::Draw(){
+		u64 tick = svcGetSystemTick();
+		if (this->lastDraw != 0 && tick - this->lastDraw < SYSCLOCK_ARM11 / RedrawRate){
+			return;
+		}
+
+		bool drawn = false;
+		for (u32 i = 0; i < (u32) HudSlot::Count; i++){
+			Line& line = this->lines[i];
+			if (!line.changed){
+				continue;
+			}
+			//Padding the line out to the full width overwrites whatever was there before, so there is no separate clear.
+			char output[Columns + 16];
+			int length = std::snprintf(output, sizeof(output), "\x1b[%u;0H%-*s", (u32) SlotRows[i], (int) Columns, line.text);
+			std::cout.write(output, std::min<int>(length, sizeof(output) - 1));
+			line.changed = false;
+			drawn = true;
+		}
+
+		if (drawn){
+			std::cout.flush();
+			this->lastDraw = tick;
+		}
+	}
+};
+
+#endif
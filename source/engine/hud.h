@@ -0,0 +1,82 @@
+#pragma once
+
+#ifndef HUD_HEADER
+#	define HUD_HEADER
+
+#include "../common.h"
+
+//The debug HUD only exists in debug builds. Release builds (make RELEASE=1, which defines NDEBUG) compile it out,
+//along with every HUD_PRINT() and its arguments.
+#ifndef NDEBUG
+#	define HUD_ENABLED
+#endif
+
+namespace Engine {
+	//Named lines of the debug HUD. Each one has a fixed row on the bottom screen, see hud.cpp.
+	enum class HudSlot {
+		Pitch,
+		Yaw,
+		TouchCoordinates,
+		OldTouches,
+		Angles,
+		InversePitch,
+		PickedObject,
+		CameraPosition,
+		CameraForward,
+		//Frame profiler readout, see Profiler. The stage lines are in ProfileStage order.
+		ProfileFrame,
+		ProfileUpdate,
+		ProfilePhysics,
+		ProfileBounds,
+		ProfilePrepare,
+		ProfileTransforms,
+		ProfileCull,
+		ProfileQueue,
+		ProfileSubmit,
+		ProfileSync,
+		ProfileGpu,
+		Count
+	};
+
+#ifdef HUD_ENABLED
+	//Fixed size text lines for the bottom screen console. The console draws text in software, so writing to it every
+	//frame shows up in frame times. Print() only formats into the slot's buffer, and Draw() writes out the slots that
+	//changed, no more often than RedrawRate times per second. Nothing here allocates.
+	class DebugHud {
+	public:
+		//Width of the bottom screen console, in characters.
+		static const u32 Columns = 40;
+		static const u32 RedrawRate = 10;
+
+		static DebugHud& Instance();
+
+		//printf style. Lines are cut off at Columns characters.
+		void Print(HudSlot slot, const char* format, ...) __attribute__((format(printf, 3, 4)));
+		void Clear(HudSlot slot);
+
+		//Writes out the slots that changed since the last redraw, if it is time for one. Call once per frame.
+		void Draw();
+
+	private:
+		struct Line {
+			char text[Columns + 1];
+			bool changed;
+		};
+
+		Line lines[(u32) HudSlot::Count] = {};
+		u64 lastDraw = 0;
+	};
+#endif
+};
+
+#ifdef HUD_ENABLED
+#	define HUD_PRINT(slot, ...) Engine::DebugHud::Instance().Print(Engine::HudSlot::slot, __VA_ARGS__)
+#	define HUD_CLEAR(slot) Engine::DebugHud::Instance().Clear(Engine::HudSlot::slot)
+#	define HUD_DRAW() Engine::DebugHud::Instance().Draw()
+#else
+#	define HUD_PRINT(slot, ...) ((void) 0)
+#	define HUD_CLEAR(slot) ((void) 0)
+#	define HUD_DRAW() ((void) 0)
+#endif
+
+#endif
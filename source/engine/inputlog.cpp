@@ -0,0 +1,138 @@
+#include "inputlog.h"
+
+namespace Engine {
+	static const char InputLogMagic[4] = { 'I', 'N', 'P', 'T' };
+	static const u16 InputLogVersion = 1;
+
+	const u32 InputLog::FlushFrames;
+
+	InputLog::~InputLog(){
+		this->Stop();
+	}
+
+	bool InputLog::StartRecording(const char* path){
+		this->Stop();
+		this->file = std::fopen(path, "wb");
+		if (!this->file){
+			return false;
+		}
+
+		//The frame count is filled in by Stop(), once it is known.
+		InputLogHeader header = {};
+		std::memcpy(header.magic, InputLogMagic, sizeof(header.magic));
+		header.version = InputLogVersion;
+		header.frameSize = sizeof(InputLogFrame);
+		std::fwrite(&header, sizeof(header), 1, this->file);
+
+		this->frames.reserve(FlushFrames);
+		return true;
+	}
+
+	bool InputLog::StartReplay(const char* path){
+		this->Stop();
+		FILE* input = std::fopen(path, "rb");
+		if (!input){
+			return false;
+		}
+
+		//The frame count has to fit in the file, or a broken log could ask for more memory than there is.
+		long fileSize = std::fseek(input, 0, SEEK_END) == 0 ? std::ftell(input) : -1;
+		InputLogHeader header;
+		bool valid = fileSize >= (long) sizeof(header) && std::fseek(input, 0, SEEK_SET) == 0 &&
+			std::fread(&header, sizeof(header), 1, input) == 1 &&
+			std::memcmp(header.magic, InputLogMagic, sizeof(header.magic)) == 0 &&
+			header.version == InputLogVersion && header.frameSize == sizeof(InputLogFrame) &&
+			(u64) header.frameCount * sizeof(InputLogFrame) <= (u64) fileSize - sizeof(header);
+		if (valid){
+			this->frames.resize(header.frameCount);
+			valid = std::fread(this->frames.data(), sizeof(InputLogFrame), header.frameCount, input) == header.frameCount;
+		}
+		std::fclose(input);
+
+		if (!valid){
+			this->frames.clear();
+			return false;
+		}
+		this->replaying = true;
+		return true;
+	}
+
+	void InputLog::Stop(){
+		if (this->file){
+			this->Flush();
+			InputLogHeader header = {};
+			std::memcpy(header.magic, InputLogMagic, sizeof(header.magic));
+			header.version = InputLogVersion;
+			header.frameSize = sizeof(InputLogFrame);
+			header.frameCount = this->position;
+			std::fseek(this->file, 0, SEEK_SET);
+			std::fwrite(&header, sizeof(header), 1, this->file);
+			std::fclose(this->file);
+			this->file = nullptr;
+		}
+		this->frames.clear();
+		this->replaying = false;
+		this->position = 0;
+		this->previousHeld = 0;
+	}
+
+	bool InputLog::IsRecording() const {
+		return this->file != nullptr;
+	}
+
+	bool InputLog::IsReplaying() const {
+		return this->replaying;
+	}
+
+	u32 InputLog::Position() const {
+		return this->position;
+	}
+
+	u32 InputLog::Length() const {
+		return this->replaying ? (u32) this->frames.size() : this->position;
+	}
+
+	bool InputLog::Process(InputState& state){
+		if (this->replaying){
+			if (this->position >= this->frames.size()){
+				this->Stop();
+				return false;
+			}
+			const InputLogFrame& frame = this->frames[this->position++];
+			state.held = frame.held;
+			state.touch.px = frame.touchX;
+			state.touch.py = frame.touchY;
+			state.deltaTime = frame.deltaTime;
+			state.slider = frame.slider;
+		}
+		else if (this->file){
+			InputLogFrame frame;
+			frame.held = state.held;
+			frame.touchX = state.touch.px;
+			frame.touchY = state.touch.py;
+			frame.deltaTime = state.deltaTime;
+			frame.slider = state.slider;
+			this->frames.push_back(frame);
+			this->position++;
+			if (this->frames.size() == FlushFrames){
+				this->Flush();
+			}
+		}
+		else {
+			return true;
+		}
+
+		//Both the recording run and the replay work out pressed and released buttons from the log, so they see the same.
+		state.down = state.held & ~this->previousHeld;
+		state.up = this->previousHeld & ~state.held;
+		this->previousHeld = state.held;
+		return true;
+	}
+
+	void InputLog::Flush(){
+		if (this->file && !this->frames.empty()){
+			std::fwrite(this->frames.data(), sizeof(InputLogFrame), this->frames.size(), this->file);
+		}
+		this->frames.clear();
+	}
+};
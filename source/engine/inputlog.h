@@ -0,0 +1,83 @@
+#pragma once
+
+#ifndef INPUTLOG_HEADER
+#	define INPUTLOG_HEADER
+
+#include "../common.h"
+
+namespace Engine {
+	//Everything from outside that goes into a frame: the buttons, the touchscreen, how long the frame took, and the 3D slider.
+	struct InputState {
+		u32 down;
+		u32 held;
+		u32 up;
+		touchPosition touch;
+		float deltaTime;
+		float slider;
+	};
+
+	//One frame of an input log. Pressed and released buttons are worked out from the held ones of the frame before,
+	//the same way hidScanInput() does it, so they are not stored.
+	struct InputLogFrame {
+		u32 held;
+		u16 touchX;
+		u16 touchY;
+		float deltaTime;
+		float slider;
+	};
+
+	static_assert(sizeof(InputLogFrame) == 16, "InputLogFrame is written to files as is.");
+
+	struct InputLogHeader {
+		char magic[4];
+		u16 version;
+		u16 frameSize;
+		u32 frameCount;
+	};
+
+	static_assert(sizeof(InputLogHeader) == 12, "InputLogHeader is written to files as is.");
+
+	//Records the input of every frame to a file, or plays a recording back in place of the real input. Frame times are
+	//part of the recording, so a replay runs the exact same physics steps and draws the exact same frames, no matter how
+	//long the frames actually take. That makes runs of different builds comparable frame by frame.
+	//
+	//A log is an InputLogHeader followed by frameCount InputLogFrames, little endian.
+	class InputLog {
+	public:
+		//Frames recorded in memory before they are written out, so the file is written in a few large pieces.
+		static const u32 FlushFrames = 256;
+
+		~InputLog();
+
+		//Starts writing a new log, replacing the file. Returns false if it cannot be created.
+		bool StartRecording(const char* path);
+
+		//Reads a whole log into memory, and starts replaying it. Returns false if it is missing or not an input log.
+		bool StartReplay(const char* path);
+
+		//Finishes the recording or the replay.
+		void Stop();
+
+		bool IsRecording() const;
+		bool IsReplaying() const;
+
+		//Call once per frame, with the real input. When recording, the input is added to the log. When replaying, it
+		//is replaced by the next frame of the log. Returns false, and stops, once the replay runs out of frames.
+		bool Process(InputState& state);
+
+		//Frames recorded or replayed so far, and the frames in the log being replayed.
+		u32 Position() const;
+		u32 Length() const;
+
+	private:
+		FILE* file = nullptr;
+		std::vector<InputLogFrame> frames;
+		u32 position = 0;
+		u32 previousHeld = 0;
+		bool replaying = false;
+
+		void Flush();
+	};
+};
+
+#endif
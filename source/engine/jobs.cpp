@@ -0,0 +1,172 @@
+#include "jobs.h"
+
+#ifndef _3DS
+#include <thread>
+#endif
+
+namespace Engine {
+	const u32 JobSystem::MaxWorkers;
+	const u32 JobSystem::QueueCapacity;
+
+	//Worker stack size. Jobs are loops over pools, so they need little stack.
+	static const size_t WorkerStackSize = 0x4000;
+
+	JobSystem& JobSystem::Instance(){
+		static JobSystem system;
+		return system;
+	}
+
+	JobSystem::JobSystem() : pendingJobs(0), running(false) {
+		for (u32 i = 0; i <= MaxWorkers; i++){
+			LightLock_Init(&this->queues[i].lock);
+			this->queues[i].head = 0;
+			this->queues[i].tail = 0;
+		}
+		LightEvent_Init(&this->workAvailable, RESET_STICKY);
+	}
+
+	JobSystem::~JobSystem(){
+		this->Release();
+	}
+
+	u32 JobSystem::DefaultWorkerCount(){
+#ifdef _3DS
+		//Only the New 3DS has an application core to spare, core 2. The Old 3DS gets no workers, and runs jobs serially.
+		bool isNew3DS = false;
+		APT_CheckNew3DS(&isNew3DS);
+		return isNew3DS ? 1 : 0;
+#else
+		u32 threads = std::thread::hardware_concurrency();
+		return std::min(threads > 1 ? threads - 1 : 0, MaxWorkers);
+#endif
+	}
+
+	void JobSystem::Initialize(){
+		this->Initialize(DefaultWorkerCount());
+	}
+
+	void JobSystem::Initialize(u32 workers){
+		this->Release();
+		workers = std::min(workers, MaxWorkers);
+		this->running.store(true);
+
+		s32 priority = 0x30;
+		svcGetThreadPriority(&priority, CUR_THREAD_HANDLE);
+		for (u32 i = 0; i < workers; i++){
+			Worker& worker = this->workers[i];
+			worker.system = this;
+			worker.queue = i + 1;
+			//Core 2 is the New 3DS's extra application core. The host ignores the core.
+			worker.thread = threadCreate(WorkerMain, &worker, WorkerStackSize, priority, 2, false);
+			if (!worker.thread){
+				break;
+			}
+			this->workerCount++;
+		}
+		std::cout << "Job system running with " << this->workerCount << " workers." << std::endl;
+	}
+
+	void JobSystem::Release(){
+		if (this->workerCount == 0){
+			return;
+		}
+		this->running.store(false);
+		LightEvent_Signal(&this->workAvailable);
+		for (u32 i = 0; i < this->workerCount; i++){
+			threadJoin(this->workers[i].thread, U64_MAX);
+			threadFree(this->workers[i].thread);
+		}
+		LightEvent_Clear(&this->workAvailable);
+		this->workerCount = 0;
+	}
+
+	u32 JobSystem::WorkerCount() const {
+		return this->workerCount;
+	}
+
+	void JobSystem::Run(u32 count, u32 grain, RangeFunction function, void* context){
+		grain = std::max(grain, 1U);
+		if (this->workerCount == 0 || count <= grain){
+			function(context, 0, count);
+			return;
+		}
+
+		//Make the chunks big enough for every one to fit in the queues.
+		const u32 threads = this->workerCount + 1;
+		const u32 capacity = threads * QueueCapacity;
+		u32 chunks = (count + grain - 1) / grain;
+		if (chunks > capacity){
+			grain = (count + capacity - 1) / capacity;
+			chunks = (count + grain - 1) / grain;
+		}
+
+		//Deal the chunks out round robin, so every thread starts with its share and only steals to even out the end.
+		this->pendingJobs.store(chunks);
+		for (u32 chunk = 0; chunk < chunks; chunk++){
+			Job job;
+			job.function = function;
+			job.context = context;
+			job.begin = chunk * grain;
+			job.end = std::min(count, job.begin + grain);
+
+			WorkQueue& queue = this->queues[chunk % threads];
+			LightLock_Lock(&queue.lock);
+			queue.jobs[queue.tail % QueueCapacity] = job;
+			queue.tail++;
+			LightLock_Unlock(&queue.lock);
+		}
+		LightEvent_Signal(&this->workAvailable);
+
+		//Help out until every chunk is done, including the ones still running on the workers.
+		while (this->pendingJobs.load() > 0){
+			this->RunOne(0);
+		}
+		LightEvent_Clear(&this->workAvailable);
+	}
+
+	bool JobSystem::RunOne(u32 queue){
+		Job job;
+		bool found = false;
+
+		WorkQueue& own = this->queues[queue];
+		LightLock_Lock(&own.lock);
+		if (own.tail != own.head){
+			own.tail--;
+			job = own.jobs[own.tail % QueueCapacity];
+			found = true;
+		}
+		LightLock_Unlock(&own.lock);
+
+		const u32 threads = this->workerCount + 1;
+		for (u32 i = 1; !found && i < threads; i++){
+			WorkQueue& victim = this->queues[(queue + i) % threads];
+			LightLock_Lock(&victim.lock);
+			if (victim.tail != victim.head){
+				job = victim.jobs[victim.head % QueueCapacity];
+				victim.head++;
+				found = true;
+			}
+			LightLock_Unlock(&victim.lock);
+		}
+
+		if (!found){
+			return false;
+		}
+		job.function(job.context, job.begin, job.end);
+		this->pendingJobs.fetch_sub(1);
+		return true;
+	}
+
+	void JobSystem::WorkerMain(void* argument){
+		Worker* worker = (Worker*) argument;
+		JobSystem* system = worker->system;
+		while (true){
+			//The event stays signalled until ParallelFor() is done, so workers only sleep between parallel loops.
+			LightEvent_Wait(&system->workAvailable);
+			if (!system->running.load()){
+				break;
+			}
+			while (system->RunOne(worker->queue)){ }
+		}
+	}
+};
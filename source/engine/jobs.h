@@ -0,0 +1,91 @@
+#pragma once
+
+#ifndef JOBS_HEADER
+#	define JOBS_HEADER
+
+#include "../common.h"
+
+#include <atomic>
+
+namespace Engine {
+	//Small job scheduler for splitting loops over many objects across the CPU cores. ParallelFor() cuts a range into
+	//chunks and deals them out to one deque per thread. Every thread, the calling one included, works through its own
+	//deque from the back, and once that is empty, steals from the front of the others, so threads that finish early take
+	//over work from slower ones. ParallelFor() returns once every chunk is done.
+	//
+	//On New 3DS, there is one worker on the extra application core (core 2). The Old 3DS has no core to spare, so it has
+	//no workers and ParallelFor() just runs the loop. The host build uses std::thread behind threadCreate().
+	//
+	//Jobs must only touch what belongs to their part of the range. They must not call ParallelFor() themselves.
+	class JobSystem {
+	public:
+		static const u32 MaxWorkers = 3;
+		static const u32 QueueCapacity = 64;
+
+		static JobSystem& Instance();
+
+		JobSystem();
+		~JobSystem();
+
+		//Starts the worker threads, as many as DefaultWorkerCount(), or the given number, capped at MaxWorkers.
+		void Initialize();
+		void Initialize(u32 workers);
+
+		//Stops and joins the workers. ParallelFor() keeps working, serially.
+		void Release();
+
+		//One per spare core: 1 on New 3DS, 0 on Old 3DS, and up to MaxWorkers on the host.
+		static u32 DefaultWorkerCount();
+		u32 WorkerCount() const;
+
+		//Calls function(begin, end) over consecutive parts of [0, count), of at least grain items each, across the threads.
+		template<typename Function> void ParallelFor(u32 count, u32 grain, Function function){
+			this->Run(count, grain, [](void* context, u32 begin, u32 end){
+				(*(Function*) context)(begin, end);
+			}, &function);
+		}
+
+	private:
+		typedef void (*RangeFunction)(void* context, u32 begin, u32 end);
+
+		struct Job {
+			RangeFunction function;
+			void* context;
+			u32 begin;
+			u32 end;
+		};
+
+		//Ring of jobs. The owning thread pushes and pops at the tail, thieves take from the head.
+		struct WorkQueue {
+			LightLock lock;
+			Job jobs[QueueCapacity];
+			u32 head;
+			u32 tail;
+		};
+
+		struct Worker {
+			JobSystem* system;
+			u32 queue;
+			Thread thread;
+		};
+
+		//Queue 0 belongs to the thread calling ParallelFor(), the others to the workers.
+		WorkQueue queues[MaxWorkers + 1];
+		Worker workers[MaxWorkers];
+		u32 workerCount = 0;
+
+		//Signalled while there is work, so idle workers sleep the rest of the time.
+		LightEvent workAvailable;
+		std::atomic<u32> pendingJobs;
+		std::atomic<bool> running;
+
+		void Run(u32 count, u32 grain, RangeFunction function, void* context);
+
+		//Runs one job from the queue's own end, or failing that, one stolen from another queue. False if there was none.
+		bool RunOne(u32 queue);
+
+		static void WorkerMain(void* argument);
+	};
+};
+
+#endif
@@ -0,0 +1,152 @@
+#include "linearallocator.h"
+
+namespace Entity {
+	const u32 LinearAllocator::BlockSizes[LinearAllocator::BlockSizeCount] = { 0x80, 0x100, 0x200, 0x400, 0x800, 0x1000 };
+	const u32 LinearAllocator::BlockSizeCount;
+	const u32 LinearAllocator::PageSize;
+	const u32 LinearAllocator::FrameCount;
+	const u32 LinearAllocator::FrameArenaSize;
+
+	LinearAllocator& LinearAllocator::Instance(){
+		static LinearAllocator allocator;
+		return allocator;
+	}
+
+	void LinearAllocator::Initialize(){
+		if (this->frameArena){
+			return;
+		}
+		this->frameArena = (u8*) linearAlloc(FrameCount * FrameArenaSize);
+		if (this->frameArena){
+			this->stats.reservedBytes += FrameCount * FrameArenaSize;
+			this->stats.systemAllocations++;
+		}
+		this->frameIndex = 0;
+		this->frameOffset = 0;
+	}
+
+	void LinearAllocator::Release(){
+		if (this->frameArena){
+			linearFree(this->frameArena);
+			this->frameArena = nullptr;
+			this->stats.reservedBytes -= FrameCount * FrameArenaSize;
+		}
+
+		//Pools with blocks still out have to keep their pages, as there is no telling which pages those blocks are in.
+		for (u32 i = 0; i < BlockSizeCount; i++){
+			BlockPool& pool = this->pools[i];
+			if (pool.usedBlocks > 0){
+				continue;
+			}
+			for (size_t page = 0; page < pool.pages.size(); page++){
+				linearFree(pool.pages[page]);
+			}
+			this->stats.reservedBytes -= (u32) pool.pages.size() * PageSize;
+			pool.pages.clear();
+			pool.freeBlocks.clear();
+		}
+	}
+
+	u32 LinearAllocator::PoolIndexOf(u32 size){
+		u32 i = 0;
+		while (i < BlockSizeCount && BlockSizes[i] < size){
+			i++;
+		}
+		return i;
+	}
+
+	bool LinearAllocator::Grow(u32 pool){
+		u8* page = (u8*) linearAlloc(PageSize);
+		if (!page){
+			return false;
+		}
+		this->stats.reservedBytes += PageSize;
+		this->stats.systemAllocations++;
+
+		//Blocks are handed out from the back of the free list, so push them in reverse to hand out the page in address order.
+		BlockPool& entry = this->pools[pool];
+		entry.pages.push_back(page);
+		for (u32 offset = PageSize; offset > 0; offset -= BlockSizes[pool]){
+			entry.freeBlocks.push_back(page + offset - BlockSizes[pool]);
+		}
+		return true;
+	}
+
+	void* LinearAllocator::Allocate(u32 size){
+		u32 pool = PoolIndexOf(size);
+		void* block = nullptr;
+		u32 blockSize = size;
+		if (pool == BlockSizeCount){
+			//Too big for any pool. These are rare, so they go to the system allocator as they are.
+			block = linearAlloc(size);
+			if (!block){
+				return nullptr;
+			}
+			this->stats.reservedBytes += size;
+			this->stats.systemAllocations++;
+		}
+		else {
+			BlockPool& entry = this->pools[pool];
+			if (entry.freeBlocks.empty() && !this->Grow(pool)){
+				return nullptr;
+			}
+			block = entry.freeBlocks.back();
+			entry.freeBlocks.pop_back();
+			entry.usedBlocks++;
+			blockSize = BlockSizes[pool];
+		}
+
+		this->stats.usedBytes += blockSize;
+		this->stats.usedHighWater = std::max(this->stats.usedHighWater, this->stats.usedBytes);
+		return block;
+	}
+
+	void LinearAllocator::Free(void* block, u32 size){
+		if (!block){
+			return;
+		}
+
+		u32 pool = PoolIndexOf(size);
+		if (pool == BlockSizeCount){
+			linearFree(block);
+			this->stats.reservedBytes -= size;
+			this->stats.usedBytes -= size;
+			return;
+		}
+
+		BlockPool& entry = this->pools[pool];
+		entry.freeBlocks.push_back(block);
+		entry.usedBlocks--;
+		this->stats.usedBytes -= BlockSizes[pool];
+	}
+
+	void LinearAllocator::Reserve(u32 size, u32 count){
+		u32 pool = PoolIndexOf(size);
+		if (pool == BlockSizeCount){
+			return;
+		}
+		while (this->pools[pool].freeBlocks.size() < count && this->Grow(pool)){ }
+	}
+
+	void LinearAllocator::BeginFrame(){
+		//The frame that used this region is FrameCount frames old, and the GPU is done with it.
+		this->stats.frameBytes = this->frameOffset;
+		this->frameIndex = (this->frameIndex + 1) % FrameCount;
+		this->frameOffset = 0;
+	}
+
+	void* LinearAllocator::AllocateFrame(u32 size, u32 alignment){
+		u32 offset = (this->frameOffset + alignment - 1) & ~(alignment - 1);
+		if (!this->frameArena || offset + size > FrameArenaSize){
+			this->stats.frameOverflows++;
+			return nullptr;
+		}
+		this->frameOffset = offset + size;
+		this->stats.frameHighWater = std::max(this->stats.frameHighWater, this->frameOffset);
+		return this->frameArena + this->frameIndex * FrameArenaSize + offset;
+	}
+
+	const LinearMemoryStats& LinearAllocator::Stats() const {
+		return this->stats;
+	}
+}
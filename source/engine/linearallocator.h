@@ -0,0 +1,93 @@
+#pragma once
+
+#ifndef LINEARALLOCATOR_HEADER
+#	define LINEARALLOCATOR_HEADER
+
+#include "../common.h"
+
+namespace Entity {
+	//What the linear allocator holds, in bytes unless said otherwise.
+	struct LinearMemoryStats {
+		//Taken from the system's linear heap, and still held. Pool pages are kept once taken.
+		u32 reservedBytes;
+		//Handed out as blocks and large allocations, and the most that ever was.
+		u32 usedBytes;
+		u32 usedHighWater;
+		//Calls made into linearAlloc(). Stays flat once the pools have grown to fit the scene.
+		u32 systemAllocations;
+		//Per-frame arena use of the last finished frame, the most any frame used, and allocations that did not fit.
+		u32 frameBytes;
+		u32 frameHighWater;
+		u32 frameOverflows;
+	};
+
+	//Front end to the linear heap, the only memory the GPU can read. linearAlloc() is a general purpose allocator
+	//over a small heap, so allocating and freeing buffers of all sizes as things come and go leaves it full of holes.
+	//Instead, GPU buffers come from here:
+	//
+	//- Blocks, for buffers that live a while, like mesh data. Sizes are rounded up to a few fixed block sizes, and each
+	//  size has a pool carved out of whole pages. Freed blocks go back to their pool, and are reused by the next buffer
+	//  of that size, so the heap only ever sees page sized allocations, and only while the pools grow. Anything larger
+	//  than the biggest block goes to linearAlloc() directly.
+	//- The frame arena, for data that is only needed by the frame being built, like dynamic vertex data or matrix blocks.
+	//  Allocating is a pointer bump, and it is all thrown away at once by BeginFrame(). There is one region per frame
+	//  in flight, so the GPU can still read last frame's data while this frame's is written.
+	class LinearAllocator {
+	public:
+		static LinearAllocator& Instance();
+
+		//Block sizes, smallest first. Every block is aligned to 0x80, like linearAlloc() itself.
+		static const u32 BlockSizeCount = 6;
+		static const u32 BlockSizes[BlockSizeCount];
+		static const u32 PageSize = 0x4000;
+
+		//Frame arena regions, and the size of each.
+		static const u32 FrameCount = 2;
+		static const u32 FrameArenaSize = 0x8000;
+
+		//Takes the frame arena from the linear heap. Call once, before the first BeginFrame().
+		void Initialize();
+
+		//Gives back the frame arena, and the pages of pools with no blocks in use.
+		void Release();
+
+		//Returns a block of at least size bytes, or nullptr if the linear heap is out of memory.
+		void* Allocate(u32 size);
+
+		//Returns a block to its pool. The size must be the one it was allocated with.
+		void Free(void* block, u32 size);
+
+		//Grows the pool for blocks of the given size until it has count free blocks, so the frame loop does not have to.
+		void Reserve(u32 size, u32 count);
+
+		//Moves on to the next frame arena region, discarding what was allocated in it FrameCount frames ago.
+		void BeginFrame();
+
+		//Bump allocates from the current frame's region. The alignment must be a power of two. Returns nullptr if the
+		//region is full, or before Initialize().
+		void* AllocateFrame(u32 size, u32 alignment = 16);
+
+		const LinearMemoryStats& Stats() const;
+
+	private:
+		struct BlockPool {
+			std::vector<void*> freeBlocks;
+			std::vector<void*> pages;
+			u32 usedBlocks = 0;
+		};
+
+		BlockPool pools[BlockSizeCount];
+		u8* frameArena = nullptr;
+		u32 frameIndex = 0;
+		u32 frameOffset = 0;
+		LinearMemoryStats stats = {};
+
+		//Index of the smallest block size that fits, or BlockSizeCount if none does.
+		static u32 PoolIndexOf(u32 size);
+
+		//Carves another page into blocks for the pool. Returns false if the linear heap is out of memory.
+		bool Grow(u32 pool);
+	};
+};
+
+#endif
@@ -0,0 +1,271 @@
+#include "mesh.h"
+
+namespace Entity {
+#ifdef _3DS
+	//Assets are packed into the romfs, see ROMFS in the Makefile. main() mounts it.
+	const char* AssetRoot = "romfs:/";
+#else
+	//The host build reads the same files straight from the romfs directory.
+	const char* AssetRoot = "romfs/";
+#endif
+
+	const u32 Mesh::MaxDetailLevels;
+
+	MeshRegistry& MeshRegistry::Instance(){
+		static MeshRegistry registry;
+		return registry;
+	}
+
+	//FNV-1a over the raw bytes.
+	static u32 HashBytes(const void* data, u32 size){
+		const u8* bytes = (const u8*) data;
+		u32 hash = 2166136261u;
+		for (u32 i = 0; i < size; i++){
+			hash = (hash ^ bytes[i]) * 16777619u;
+		}
+		return hash;
+	}
+
+	Handle MeshRegistry::Acquire(const Vertex list[], int size){
+		const u32 bytes = size * sizeof(Vertex);
+		std::vector<PackedVertex> vertices;
+		std::vector<u16> indices;
+		float positionScale;
+
+		//There are only a handful of meshes, so a sweep is enough to find one uploaded from the same data.
+		//Same pointer is the cheap case. Otherwise, a mesh with the same hash is only shared if the data packs the same.
+		u32 hash = 0;
+		bool hashed = false, packed = false;
+		for (size_t i = 0; i < this->meshes.size(); i++){
+			Mesh& mesh = this->meshes[i];
+			if (mesh.references == 0 || mesh.sourceCount != (u32) size){
+				continue;
+			}
+			if (mesh.source != list){
+				if (!hashed){
+					hash = HashBytes(list, bytes);
+					hashed = true;
+				}
+				if (mesh.hash != hash){
+					continue;
+				}
+				if (!packed){
+					if (!PackMesh(list, size, vertices, indices, positionScale)){
+						return InvalidHandle;
+					}
+					packed = true;
+				}
+				if (mesh.vertexCount != vertices.size() || mesh.positionScale != positionScale ||
+					std::memcmp(mesh.vertexBuffer, vertices.data(), vertices.size() * sizeof(PackedVertex)) != 0 ||
+					std::memcmp(mesh.indexBuffer, indices.data(), indices.size() * sizeof(u16)) != 0){
+					continue;
+				}
+			}
+			mesh.references++;
+			return mesh.handle;
+		}
+
+		if (!packed && !PackMesh(list, size, vertices, indices, positionScale)){
+			return InvalidHandle;
+		}
+
+		Mesh mesh;
+		mesh.stride = sizeof(PackedVertex);
+		mesh.vertexCount = (u32) vertices.size();
+		mesh.indexCount = (u32) indices.size();
+		mesh.positionScale = positionScale;
+		mesh.references = 1;
+		mesh.source = list;
+		mesh.sourceCount = size;
+		mesh.hash = hashed ? hash : HashBytes(list, bytes);
+		ComputeMeshBounds(list, size, mesh.minimum, mesh.maximum, mesh.center, mesh.radius);
+
+		//Both buffers are read by the GPU, so both go in linear memory.
+		const u32 vertexBytes = mesh.vertexCount * sizeof(PackedVertex);
+		const u32 indexBytes = mesh.indexCount * sizeof(u16);
+		mesh.vertexBuffer = LinearAllocator::Instance().Allocate(vertexBytes);
+		mesh.indexBuffer = (u16*) LinearAllocator::Instance().Allocate(indexBytes);
+		if (!mesh.vertexBuffer || !mesh.indexBuffer){
+			std::cout << "Out of linear memory for a mesh." << std::endl;
+			LinearAllocator::Instance().Free(mesh.vertexBuffer, vertexBytes);
+			LinearAllocator::Instance().Free(mesh.indexBuffer, indexBytes);
+			return InvalidHandle;
+		}
+		std::memcpy(mesh.vertexBuffer, vertices.data(), vertexBytes);
+		std::memcpy(mesh.indexBuffer, indices.data(), indexBytes);
+		this->linearMemoryUsed += vertexBytes + indexBytes;
+		return this->Insert(mesh);
+	}
+
+	Handle MeshRegistry::Load(const char* name){
+		for (size_t i = 0; i < this->meshes.size(); i++){
+			Mesh& mesh = this->meshes[i];
+			if (mesh.references > 0 && mesh.asset == name){
+				mesh.references++;
+				return mesh.handle;
+			}
+		}
+
+		std::string path = std::string(AssetRoot) + name;
+		FILE* file = std::fopen(path.c_str(), "rb");
+		if (!file){
+			std::cout << "Cannot open mesh " << path << std::endl;
+			return InvalidHandle;
+		}
+
+		MeshFileHeader header;
+		if (std::fread(&header, sizeof(header), 1, file) != 1 || !IsCompatibleMeshFile(header)){
+			std::cout << "Not a usable mesh file: " << path << std::endl;
+			std::fclose(file);
+			return InvalidHandle;
+		}
+
+		//The blobs are already in the layout the GPU reads, so they are read straight into linear memory.
+		Mesh mesh;
+		mesh.stride = header.stride;
+		mesh.vertexCount = header.vertexCount;
+		mesh.indexCount = header.indexCount;
+		mesh.positionScale = header.positionScale;
+		mesh.minimum = FVec3_New(header.minimum[0], header.minimum[1], header.minimum[2]);
+		mesh.maximum = FVec3_New(header.maximum[0], header.maximum[1], header.maximum[2]);
+		mesh.center = FVec3_New(header.center[0], header.center[1], header.center[2]);
+		mesh.radius = header.radius;
+		mesh.references = 1;
+		mesh.asset = name;
+
+		const u32 vertexBytes = mesh.vertexCount * mesh.stride;
+		const u32 indexBytes = mesh.indexCount * sizeof(u16);
+		mesh.vertexBuffer = LinearAllocator::Instance().Allocate(vertexBytes);
+		mesh.indexBuffer = (u16*) LinearAllocator::Instance().Allocate(indexBytes);
+		bool loaded = mesh.vertexBuffer && mesh.indexBuffer &&
+			std::fseek(file, header.vertexOffset, SEEK_SET) == 0 && std::fread(mesh.vertexBuffer, 1, vertexBytes, file) == vertexBytes &&
+			std::fseek(file, header.indexOffset, SEEK_SET) == 0 && std::fread(mesh.indexBuffer, 1, indexBytes, file) == indexBytes;
+		std::fclose(file);
+
+		if (!loaded){
+			std::cout << "Truncated mesh file, or out of linear memory: " << path << std::endl;
+			LinearAllocator::Instance().Free(mesh.vertexBuffer, vertexBytes);
+			LinearAllocator::Instance().Free(mesh.indexBuffer, indexBytes);
+			return InvalidHandle;
+		}
+
+		this->linearMemoryUsed += vertexBytes + indexBytes;
+		return this->Insert(mesh);
+	}
+
+	Handle MeshRegistry::Insert(Mesh& mesh){
+		//Meshes are stored at their handle's slot index, and freed slots are reused by the handle table.
+		mesh.handle = this->handles.Create(0);
+		u32 slot = HandleTable::IndexOf(mesh.handle);
+		this->handles.Set(mesh.handle, slot);
+		if (slot >= this->meshes.size()){
+			this->meshes.resize(slot + 1);
+		}
+		this->meshes[slot] = mesh;
+		return mesh.handle;
+	}
+
+	Handle MeshRegistry::AddReference(Handle mesh){
+		u32 slot = this->handles.Get(mesh);
+		if (slot == HandleTable::InvalidValue){
+			return InvalidHandle;
+		}
+		this->meshes[slot].references++;
+		return mesh;
+	}
+
+	void MeshRegistry::Release(Handle mesh){
+		u32 slot = this->handles.Get(mesh);
+		if (slot == HandleTable::InvalidValue){
+			return;
+		}
+
+		Mesh& entry = this->meshes[slot];
+		if (--entry.references > 0){
+			return;
+		}
+
+		//Last game object using the mesh is gone, so the vertex buffer can go too. The blocks go back to the
+		//linear allocator's pools, ready for the next mesh of about the same size.
+		std::cout << "Freeing allocated memory." << std::endl;
+		const u32 vertexBytes = entry.vertexCount * entry.stride;
+		const u32 indexBytes = entry.indexCount * sizeof(u16);
+		LinearAllocator::Instance().Free(entry.vertexBuffer, vertexBytes);
+		LinearAllocator::Instance().Free(entry.indexBuffer, indexBytes);
+		this->linearMemoryUsed -= vertexBytes + indexBytes;
+		entry.vertexBuffer = nullptr;
+		entry.indexBuffer = nullptr;
+		entry.asset.clear();
+		entry.source = nullptr;
+		this->handles.Destroy(mesh);
+
+		//The detail levels are meshes of their own, with the reference AddDetailLevel() took on them.
+		u32 detailCount = entry.detailCount;
+		Handle detailMeshes[Mesh::MaxDetailLevels];
+		std::copy(entry.detailMeshes, entry.detailMeshes + detailCount, detailMeshes);
+		entry.detailCount = 0;
+		for (u32 i = 0; i < detailCount; i++){
+			this->Release(detailMeshes[i]);
+		}
+	}
+
+	bool MeshRegistry::AddDetailLevel(Handle mesh, Handle level, float screenSize){
+		u32 slot = this->handles.Get(mesh);
+		if (slot == HandleTable::InvalidValue || level == mesh || !this->handles.IsValid(level)){
+			return false;
+		}
+		Mesh& entry = this->meshes[slot];
+		if (entry.detailCount == Mesh::MaxDetailLevels || (entry.detailCount > 0 && screenSize >= entry.detailSizes[entry.detailCount - 1])){
+			return false;
+		}
+		entry.detailMeshes[entry.detailCount] = this->AddReference(level);
+		entry.detailSizes[entry.detailCount] = screenSize;
+		entry.detailCount++;
+		return true;
+	}
+
+	u32 MeshRegistry::SelectDetailLevel(Handle mesh, float screenSize, u32 current) const {
+		const Mesh* entry = this->Get(mesh);
+		if (!entry){
+			return 0;
+		}
+
+		//Level n is drawn below detailSizes[n - 1]. Going coarser takes dropping a bit below the size, and going finer
+		//getting a bit above it, so there is a band around each size where the object keeps whatever level it had.
+		u32 level = std::min(current, entry->detailCount);
+		while (level < entry->detailCount && screenSize < entry->detailSizes[level] * (1.0f - this->DetailHysteresis)){
+			level++;
+		}
+		while (level > 0 && screenSize > entry->detailSizes[level - 1] * (1.0f + this->DetailHysteresis)){
+			level--;
+		}
+		return level;
+	}
+
+	Handle MeshRegistry::DetailMesh(Handle mesh, u32 level) const {
+		const Mesh* entry = this->Get(mesh);
+		if (!entry || level == 0 || level > entry->detailCount){
+			return mesh;
+		}
+		return entry->detailMeshes[level - 1];
+	}
+
+	const Mesh* MeshRegistry::Get(Handle mesh) const {
+		u32 slot = this->handles.Get(mesh);
+		return (slot != HandleTable::InvalidValue) ? &this->meshes[slot] : nullptr;
+	}
+
+	u32 MeshRegistry::Count() const {
+		u32 count = 0;
+		for (size_t i = 0; i < this->meshes.size(); i++){
+			if (this->meshes[i].references > 0){
+				count++;
+			}
+		}
+		return count;
+	}
+
+	u32 MeshRegistry::LinearMemoryUsed() const {
+		return this->linearMemoryUsed;
+	}
+}
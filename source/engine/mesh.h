@@ -0,0 +1,108 @@
+#pragma once
+
+#ifndef MESH_HEADER
+#	define MESH_HEADER
+
+#include "../common.h"
+#include "handle.h"
+#include "linearallocator.h"
+#include "meshformat.h"
+
+namespace Entity {
+	//Directory mesh and scene files are read from. The romfs on the 3DS, and the romfs directory on the host.
+	extern const char* AssetRoot;
+
+	//Vertex data uploaded once to linear memory, and shared by every game object drawing it. Stored indexed, as
+	//unique PackedVertex entries and triangle list indices into them.
+	struct Mesh {
+		Mesh() : vertexBuffer(nullptr), indexBuffer(nullptr), vertexCount(0), indexCount(0), stride(0), positionScale(1.0f), references(0), handle(InvalidHandle), radius(0.0f), detailCount(0), source(nullptr), sourceCount(0), hash(0) { }
+
+		void* vertexBuffer;
+		u16* indexBuffer;
+		u32 vertexCount;
+		u32 indexCount;
+		u32 stride;
+
+		//Model space size of one unit of the packed positions. Goes into the model matrix, see GameObject::RenderUpdate().
+		float positionScale;
+
+		u32 references;
+		Handle handle;
+
+		//Bounds of the vertex positions, in model space. The sphere is centered on the box.
+		C3D_FVec minimum, maximum, center;
+		float radius;
+
+		//Coarser versions of this mesh, finest first, and the screen size below which each one is drawn instead. A screen
+		//size is the diameter of an object's bounding sphere over the height of the screen. See MeshRegistry::AddDetailLevel().
+		static const u32 MaxDetailLevels = 3;
+		Handle detailMeshes[MaxDetailLevels];
+		float detailSizes[MaxDetailLevels];
+		u32 detailCount;
+
+		//The data the mesh was uploaded from, its vertex count, and a hash of its contents. Used to find the mesh again when
+		//the same data is acquired twice, even through another copy of it.
+		const void* source;
+		u32 sourceCount;
+		u32 hash;
+
+		//File name the mesh was loaded from, for meshes from Load().
+		std::string asset;
+	};
+
+	//Reference counted cache of meshes. Acquiring the same source data again hands out the mesh that is already
+	//in linear memory, instead of allocating and copying another one.
+	class MeshRegistry {
+	public:
+		static MeshRegistry& Instance();
+
+		//Returns the mesh for the vertex list, uploading it on first use. Adds a reference. The list is a plain triangle list,
+		//which is packed and indexed on upload, merging vertices that pack the same. Returns InvalidHandle if that leaves
+		//more vertices than 16-bit indices can reach.
+		Handle Acquire(const Vertex list[], int size);
+
+		//Returns the mesh loaded from the named mesh file in the romfs (see meshformat.h), loading it on first use.
+		//Adds a reference. Returns InvalidHandle if the file is missing or not made for this vertex layout.
+		Handle Load(const char* name);
+
+		//Adds a reference to a mesh that is already registered. Returns the same handle.
+		Handle AddReference(Handle mesh);
+
+		//Drops a reference. The last one frees the vertex buffer and invalidates the handle, and drops the mesh's detail levels.
+		void Release(Handle mesh);
+
+		//How far past a detail level's screen size an object has to get before it switches, as a fraction of that size.
+		//Keeps objects sitting right at a threshold from flickering between two levels.
+		const float DetailHysteresis = 0.15f;
+
+		//Makes level the next coarser detail level of the mesh, drawn instead of it for objects smaller than screenSize on
+		//the screen. Levels go finest first, so each screenSize must be below the last one's. Adds a reference to level,
+		//dropped again when the mesh is freed. Returns false, and changes nothing, if the mesh already has
+		//Mesh::MaxDetailLevels, the size does not shrink, or either handle is stale.
+		bool AddDetailLevel(Handle mesh, Handle level, float screenSize);
+
+		//Detail level to draw the mesh at, for an object covering screenSize of the screen that was drawn at level current
+		//last frame. Level 0 is the mesh itself.
+		u32 SelectDetailLevel(Handle mesh, float screenSize, u32 current) const;
+
+		//Mesh drawn at the detail level. Level 0, or any level of a mesh without that many, is the mesh itself.
+		Handle DetailMesh(Handle mesh, u32 level) const;
+
+		//Returns nullptr if the handle is stale.
+		const Mesh* Get(Handle mesh) const;
+
+		//Number of live meshes, and the linear memory their data takes up. The blocks holding it are rounded up, see LinearAllocator::Stats().
+		u32 Count() const;
+		u32 LinearMemoryUsed() const;
+
+	private:
+		HandleTable handles;
+		std::vector<Mesh> meshes;
+		u32 linearMemoryUsed = 0;
+
+		//Gives the mesh a handle and a slot.
+		Handle Insert(Mesh& mesh);
+	};
+};
+
+#endif
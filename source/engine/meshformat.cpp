@@ -0,0 +1,101 @@
+#include "meshformat.h"
+
+namespace Entity {
+	void InitializeMeshFileHeader(MeshFileHeader& header){
+		std::memset(&header, 0, sizeof(header));
+		std::memcpy(header.magic, MeshFileMagic, sizeof(header.magic));
+		header.version = MeshFileVersion;
+		header.headerSize = sizeof(MeshFileHeader);
+
+		//Matches the attribute loaders in Core::Initialize().
+		header.stride = sizeof(PackedVertex);
+		header.attributeCount = 3;
+		header.indexFormat = C3D_UNSIGNED_SHORT;
+		header.attributeFormats[0] = GPU_SHORT;
+		header.attributeFormats[1] = GPU_SHORT;
+		header.attributeFormats[2] = GPU_BYTE;
+		header.attributeSizes[0] = 3;
+		header.attributeSizes[1] = 2;
+		header.attributeSizes[2] = 3;
+	}
+
+	bool IsCompatibleMeshFile(const MeshFileHeader& header){
+		MeshFileHeader expected;
+		InitializeMeshFileHeader(expected);
+		return std::memcmp(header.magic, expected.magic, sizeof(header.magic)) == 0 &&
+			header.version == expected.version &&
+			header.headerSize == expected.headerSize &&
+			header.stride == expected.stride &&
+			header.attributeCount == expected.attributeCount &&
+			header.indexFormat == expected.indexFormat &&
+			std::memcmp(header.attributeFormats, expected.attributeFormats, sizeof(header.attributeFormats)) == 0 &&
+			std::memcmp(header.attributeSizes, expected.attributeSizes, sizeof(header.attributeSizes)) == 0;
+	}
+
+	struct PackedVertexLess {
+		bool operator()(const PackedVertex& lhs, const PackedVertex& rhs) const {
+			return std::memcmp(&lhs, &rhs, sizeof(PackedVertex)) < 0;
+		}
+	};
+
+	static s16 Quantize(float value, float scale, float limit){
+		float scaled = std::round(value * scale);
+		return (s16) std::max(-limit, std::min(limit, scaled));
+	}
+
+	bool PackMesh(const Vertex list[], int size, std::vector<PackedVertex>& vertices, std::vector<u16>& indices, float& positionScale){
+		float extent = 0.0f;
+		for (int i = 0; i < size; i++){
+			for (int axis = 0; axis < 3; axis++){
+				extent = std::max(extent, std::abs(list[i].positions[axis]));
+			}
+		}
+		positionScale = extent > 0.0f ? extent / 32767.0f : 1.0f;
+
+		std::map<PackedVertex, u16, PackedVertexLess> unique;
+		vertices.clear();
+		indices.clear();
+		indices.reserve(size);
+		for (int i = 0; i < size; i++){
+			PackedVertex packed;
+			for (int axis = 0; axis < 3; axis++){
+				packed.positions[axis] = Quantize(list[i].positions[axis], 1.0f / positionScale, 32767.0f);
+				packed.normals[axis] = (s8) Quantize(list[i].normals[axis], 127.0f, 127.0f);
+			}
+			packed.texcoords[0] = Quantize(list[i].texcoords[0], 4096.0f, 32767.0f);
+			packed.texcoords[1] = Quantize(list[i].texcoords[1], 4096.0f, 32767.0f);
+			packed.padding = 0;
+
+			auto found = unique.find(packed);
+			if (found == unique.end()){
+				if (vertices.size() > 0xFFFF){
+					return false;
+				}
+				found = unique.insert(std::make_pair(packed, (u16) vertices.size())).first;
+				vertices.push_back(packed);
+			}
+			indices.push_back(found->second);
+		}
+		return true;
+	}
+
+	void ComputeMeshBounds(const Vertex list[], int size, C3D_FVec& minimum, C3D_FVec& maximum, C3D_FVec& center, float& radius){
+		minimum = maximum = FVec3_New(0.0f, 0.0f, 0.0f);
+		for (int i = 0; i < size; i++){
+			const float* p = list[i].positions;
+			if (i == 0){
+				minimum = maximum = FVec3_New(p[0], p[1], p[2]);
+				continue;
+			}
+			minimum = FVec3_New(std::min(minimum.x, p[0]), std::min(minimum.y, p[1]), std::min(minimum.z, p[2]));
+			maximum = FVec3_New(std::max(maximum.x, p[0]), std::max(maximum.y, p[1]), std::max(maximum.z, p[2]));
+		}
+
+		center = FVec3_Scale(FVec3_Add(minimum, maximum), 0.5f);
+		radius = 0.0f;
+		for (int i = 0; i < size; i++){
+			const float* p = list[i].positions;
+			radius = std::max(radius, FVec3_Distance(center, FVec3_New(p[0], p[1], p[2])));
+		}
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#ifndef MESHFORMAT_HEADER
+#	define MESHFORMAT_HEADER
+
+#include "../common.h"
+
+namespace Entity {
+	//Binary mesh files, as written by tools/meshconv and read by MeshRegistry::Load(). A file is this header, followed
+	//by the vertex and index blobs at the given offsets. The blobs are exactly what the GPU reads (PackedVertex and
+	//16-bit indices), aligned to 16 bytes, so loading is a read straight into linear memory with nothing to parse.
+	//Everything is little endian, like both the 3DS and the machines running the converter.
+	struct MeshFileHeader {
+		char magic[4];
+		u16 version;
+		u16 headerSize;
+
+		//Vertex layout, so files made for another layout get rejected instead of drawn as garbage.
+		u16 stride;
+		u8 attributeCount;
+		u8 indexFormat;
+		u8 attributeFormats[4];
+		u8 attributeSizes[4];
+
+		u32 vertexCount;
+		u32 indexCount;
+		u32 vertexOffset;
+		u32 indexOffset;
+
+		//See Mesh.
+		float positionScale;
+		float minimum[3];
+		float maximum[3];
+		float center[3];
+		float radius;
+	};
+
+	static_assert(sizeof(MeshFileHeader) == 80, "MeshFileHeader must stay 80 bytes, files are read into it directly.");
+
+	static const char MeshFileMagic[4] = { 'M', 'E', 'S', 'H' };
+	static const u16 MeshFileVersion = 1;
+	static const u32 MeshFileAlignment = 16;
+
+	//Fills in everything but the counts, offsets and bounds, for the vertex layout the engine draws with.
+	void InitializeMeshFileHeader(MeshFileHeader& header);
+
+	//True if the header is a mesh file this build can draw.
+	bool IsCompatibleMeshFile(const MeshFileHeader& header);
+
+	//Turns a float triangle list into unique packed vertices and indices. Positions use the full 16-bit range over the
+	//largest coordinate, so precision follows the size of the mesh. Returns false if there are too many unique vertices.
+	bool PackMesh(const Vertex list[], int size, std::vector<PackedVertex>& vertices, std::vector<u16>& indices, float& positionScale);
+
+	//Box around the positions, and a sphere centered on the box. Not the tightest sphere, but close for boxy meshes, and cheap.
+	void ComputeMeshBounds(const Vertex list[], int size, C3D_FVec& minimum, C3D_FVec& maximum, C3D_FVec& center, float& radius);
+};
+
+#endif
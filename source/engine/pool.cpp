@@ -0,0 +1,620 @@
+#include "pool.h"
+
+namespace Entity {
+	const u8 TransformPool::Alive;
+	const u8 TransformPool::Dirty;
+
+	void TransformPool::Create(u32 id){
+		TransformComponent defaults;
+
+		if (id >= this->position.size()){
+			this->position.resize(id + 1);
+			this->rotation.resize(id + 1);
+			this->scale.resize(id + 1);
+			this->previousPosition.resize(id + 1);
+			this->previousRotation.resize(id + 1);
+			this->parent.resize(id + 1, InvalidHandle);
+			this->firstChild.resize(id + 1, InvalidHandle);
+			this->nextSibling.resize(id + 1, InvalidHandle);
+			this->world.resize(id + 1);
+			this->flags.resize(id + 1, 0);
+		}
+		this->Set(id, defaults);
+		this->previousPosition[id] = defaults.position;
+		this->previousRotation[id] = defaults.rotation;
+		this->parent[id] = InvalidHandle;
+		this->firstChild[id] = InvalidHandle;
+		this->nextSibling[id] = InvalidHandle;
+		Mtx_Identity(&this->world[id]);
+		this->flags[id] = Alive | Dirty;
+	}
+
+	void TransformPool::Destroy(u32 id){
+		if (id >= this->flags.size() || !(this->flags[id] & Alive)){
+			return;
+		}
+		this->Unlink(id);
+
+		//Orphan the children.
+		Handle child = this->firstChild[id];
+		while (child != InvalidHandle){
+			u32 childId = HandleTable::IndexOf(child);
+			child = this->nextSibling[childId];
+			this->parent[childId] = InvalidHandle;
+			this->nextSibling[childId] = InvalidHandle;
+			this->flags[childId] |= Dirty;
+		}
+		this->firstChild[id] = InvalidHandle;
+		this->flags[id] = 0;
+	}
+
+	bool TransformPool::SetParent(Handle child, Handle newParent){
+		u32 id = HandleTable::IndexOf(child);
+		if (this->parent[id] == newParent){
+			return true;
+		}
+
+		//Walking up from the new parent must not run into the child.
+		for (Handle ancestor = newParent; ancestor != InvalidHandle; ancestor = this->parent[HandleTable::IndexOf(ancestor)]){
+			if (ancestor == child){
+				return false;
+			}
+		}
+
+		this->Unlink(id);
+		if (newParent != InvalidHandle){
+			u32 parentId = HandleTable::IndexOf(newParent);
+			this->parent[id] = newParent;
+			this->nextSibling[id] = this->firstChild[parentId];
+			this->firstChild[parentId] = child;
+		}
+		this->flags[id] |= Dirty;
+		return true;
+	}
+
+	void TransformPool::MarkDirty(u32 id){
+		this->flags[id] |= Dirty;
+	}
+
+	void TransformPool::Place(u32 id, C3D_FVec position, C3D_FQuat rotation){
+		this->position[id] = this->previousPosition[id] = position;
+		this->rotation[id] = this->previousRotation[id] = rotation;
+		this->flags[id] |= Dirty;
+	}
+
+	void TransformPool::UpdateWorldMatrices(float alpha){
+		this->UpdateWorldMatrices(alpha, 0, this->Size());
+	}
+
+	void TransformPool::UpdateWorldMatrices(float alpha, u32 begin, u32 end){
+		//Start from the root transforms. Children are reached through their parents, so they always see an up to date parent matrix.
+		//A root's world matrix is its local matrix, so the dirty roots, which are most of the work, are gathered into
+		//batches and built in one go, then their children are updated.
+		const u32 BatchSize = 32;
+		u32 batch[BatchSize];
+		C3D_FVec positions[BatchSize];
+		C3D_FQuat rotations[BatchSize];
+		C3D_FVec scales[BatchSize];
+		C3D_Mtx matrices[BatchSize];
+		u32 count = 0;
+		auto build = [&](){
+			Engine::BatchMath::ComposeMatrices(matrices, positions, rotations, scales, count);
+			for (u32 n = 0; n < count; n++){
+				this->world[batch[n]] = matrices[n];
+				this->FinishWorldMatrix(batch[n], true, alpha);
+			}
+			count = 0;
+		};
+
+		for (u32 id = begin; id < end; id++){
+			//Children are updated by whichever range holds their root, which clears their Dirty bit, so their flags must
+			//not even be read here. Parents are only changed between updates, so they are safe to check first.
+			if (this->parent[id] != InvalidHandle || !(this->flags[id] & Alive)){
+				continue;
+			}
+			if (!(this->flags[id] & Dirty)){
+				this->FinishWorldMatrix(id, false, alpha);
+				continue;
+			}
+			batch[count] = id;
+			positions[count] = this->InterpolatePosition(id, alpha);
+			rotations[count] = this->InterpolateRotation(id, alpha);
+			scales[count] = this->scale[id];
+			if (++count == BatchSize){
+				build();
+			}
+		}
+		if (count > 0){
+			build();
+		}
+	}
+
+	C3D_FVec TransformPool::WorldPosition(u32 id) const {
+		const C3D_Mtx& matrix = this->world[id];
+		return FVec4_New(matrix.r[0].w, matrix.r[1].w, matrix.r[2].w, 1.0f);
+	}
+
+	void TransformPool::Unlink(u32 id){
+		Handle oldParent = this->parent[id];
+		if (oldParent == InvalidHandle){
+			return;
+		}
+
+		//Find whichever link points at us, either the parent's first child or a sibling, and skip over us.
+		Handle* link = &this->firstChild[HandleTable::IndexOf(oldParent)];
+		while (*link != InvalidHandle && HandleTable::IndexOf(*link) != id){
+			link = &this->nextSibling[HandleTable::IndexOf(*link)];
+		}
+		if (*link != InvalidHandle){
+			*link = this->nextSibling[id];
+		}
+		this->parent[id] = InvalidHandle;
+		this->nextSibling[id] = InvalidHandle;
+	}
+
+	void TransformPool::UpdateWorldMatrix(u32 id, bool parentChanged, float alpha){
+		bool changed = parentChanged || (this->flags[id] & Dirty);
+		if (changed){
+			//Local matrix is translation * rotation * scale, and goes after the parent's world matrix.
+			C3D_FVec localPosition = this->InterpolatePosition(id, alpha);
+			C3D_FQuat localRotation = this->InterpolateRotation(id, alpha);
+			C3D_Mtx local;
+			Engine::BatchMath::ComposeMatrices(&local, &localPosition, &localRotation, &this->scale[id], 1);
+
+			if (this->parent[id] != InvalidHandle){
+				Mtx_Multiply(&this->world[id], &this->world[HandleTable::IndexOf(this->parent[id])], &local);
+			}
+			else {
+				this->world[id] = local;
+			}
+		}
+		this->FinishWorldMatrix(id, changed, alpha);
+	}
+
+	void TransformPool::FinishWorldMatrix(u32 id, bool changed, float alpha){
+		if (changed){
+			//Once the previous and current states match, blending gives the same matrix at any alpha, so it can stay as is.
+			bool resting = std::memcmp(&this->position[id], &this->previousPosition[id], sizeof(C3D_FVec)) == 0 &&
+				std::memcmp(&this->rotation[id], &this->previousRotation[id], sizeof(C3D_FQuat)) == 0;
+			if (resting){
+				this->flags[id] &= ~Dirty;
+			}
+		}
+
+		for (Handle child = this->firstChild[id]; child != InvalidHandle; child = this->nextSibling[HandleTable::IndexOf(child)]){
+			this->UpdateWorldMatrix(HandleTable::IndexOf(child), changed, alpha);
+		}
+	}
+
+	void TransformPool::SaveState(){
+		std::copy(this->position.begin(), this->position.end(), this->previousPosition.begin());
+		std::copy(this->rotation.begin(), this->rotation.end(), this->previousRotation.begin());
+	}
+
+	C3D_FVec TransformPool::InterpolatePosition(u32 id, float alpha) const {
+		const C3D_FVec& from = this->previousPosition[id];
+		const C3D_FVec& to = this->position[id];
+		return FVec4_New(from.x + (to.x - from.x) * alpha, from.y + (to.y - from.y) * alpha, from.z + (to.z - from.z) * alpha, to.w);
+	}
+
+	C3D_FQuat TransformPool::InterpolateRotation(u32 id, float alpha) const {
+		return Quat_MyNlerp(this->previousRotation[id], this->rotation[id], alpha);
+	}
+
+	void TransformPool::Set(u32 id, const TransformComponent& component){
+		this->position[id] = component.position;
+		this->rotation[id] = component.rotation;
+		this->scale[id] = component.scale;
+		this->flags[id] |= Dirty;
+	}
+
+	TransformComponent TransformPool::Get(u32 id) const {
+		TransformComponent result;
+		result.position = this->position[id];
+		result.rotation = this->rotation[id];
+		result.scale = this->scale[id];
+		result.parent = this->parent[id];
+		return result;
+	}
+
+	u32 TransformPool::Size() const {
+		return (u32) this->position.size();
+	}
+
+	void TransformPool::Reserve(u32 count){
+		this->position.reserve(count);
+		this->rotation.reserve(count);
+		this->scale.reserve(count);
+		this->previousPosition.reserve(count);
+		this->previousRotation.reserve(count);
+		this->parent.reserve(count);
+		this->firstChild.reserve(count);
+		this->nextSibling.reserve(count);
+		this->world.reserve(count);
+		this->flags.reserve(count);
+	}
+
+	//------------------------------------------------------------------------------------
+
+	Handle PhysicsPool::Add(Handle object, const PhysicsComponent& component){
+		u32 index = (u32) this->body.size();
+		Handle handle = this->bodies.Create(index);
+		this->owner.push_back(object);
+		this->body.push_back(handle);
+		this->ax.push_back(component.ax);
+		this->ay.push_back(component.ay);
+		this->az.push_back(component.az);
+		this->vx.push_back(component.vx);
+		this->vy.push_back(component.vy);
+		this->vz.push_back(component.vz);
+		this->halfExtents.push_back(component.halfExtents);
+		this->restTime.push_back(0.0f);
+		this->asleep.push_back(0);
+		this->island.push_back(InvalidHandle);
+		this->islandNext.push_back(InvalidHandle);
+		return handle;
+	}
+
+	u32 PhysicsPool::AddBodies(const Handle* objects, u32 count){
+		u32 first = (u32) this->body.size();
+		u32 size = first + count;
+		this->ax.resize(size, 0.0f);
+		this->ay.resize(size, 0.0f);
+		this->az.resize(size, 0.0f);
+		this->vx.resize(size, 0.0f);
+		this->vy.resize(size, 0.0f);
+		this->vz.resize(size, 0.0f);
+		this->halfExtents.resize(size, FVec3_New(0.0f, 0.0f, 0.0f));
+		this->restTime.resize(size, 0.0f);
+		this->asleep.resize(size, 0);
+		this->island.resize(size, InvalidHandle);
+		this->islandNext.resize(size, InvalidHandle);
+		this->owner.insert(this->owner.end(), objects, objects + count);
+		this->body.resize(size);
+		for (u32 i = first; i < size; i++){
+			this->body[i] = this->bodies.Create(i);
+		}
+		return first;
+	}
+
+	void PhysicsPool::Reserve(u32 count){
+		this->ax.reserve(count);
+		this->ay.reserve(count);
+		this->az.reserve(count);
+		this->vx.reserve(count);
+		this->vy.reserve(count);
+		this->vz.reserve(count);
+		this->halfExtents.reserve(count);
+		this->restTime.reserve(count);
+		this->asleep.reserve(count);
+		this->island.reserve(count);
+		this->islandNext.reserve(count);
+		this->owner.reserve(count);
+		this->body.reserve(count);
+	}
+
+	void PhysicsPool::Set(Handle handle, const PhysicsComponent& component){
+		u32 index = this->IndexOf(handle);
+		if (index == HandleTable::InvalidValue){
+			return;
+		}
+		this->Wake(handle);
+		this->ax[index] = component.ax;
+		this->ay[index] = component.ay;
+		this->az[index] = component.az;
+		this->vx[index] = component.vx;
+		this->vy[index] = component.vy;
+		this->vz[index] = component.vz;
+		this->halfExtents[index] = component.halfExtents;
+	}
+
+	void PhysicsPool::Remove(Handle handle){
+		u32 index = this->IndexOf(handle);
+		if (index == HandleTable::InvalidValue){
+			return;
+		}
+
+		//Whatever was resting on the body has to fall now.
+		this->Wake(handle);
+		this->bodies.Destroy(handle);
+
+		//Keep the arrays dense by moving the last body into the hole.
+		u32 last = (u32) this->body.size() - 1;
+		if (index != last){
+			this->ax[index] = this->ax[last];
+			this->ay[index] = this->ay[last];
+			this->az[index] = this->az[last];
+			this->vx[index] = this->vx[last];
+			this->vy[index] = this->vy[last];
+			this->vz[index] = this->vz[last];
+			this->halfExtents[index] = this->halfExtents[last];
+			this->restTime[index] = this->restTime[last];
+			this->asleep[index] = this->asleep[last];
+			this->island[index] = this->island[last];
+			this->islandNext[index] = this->islandNext[last];
+			this->owner[index] = this->owner[last];
+			this->body[index] = this->body[last];
+			this->bodies.Set(this->body[index], index);
+		}
+
+		this->ax.pop_back();
+		this->ay.pop_back();
+		this->az.pop_back();
+		this->vx.pop_back();
+		this->vy.pop_back();
+		this->vz.pop_back();
+		this->halfExtents.pop_back();
+		this->restTime.pop_back();
+		this->asleep.pop_back();
+		this->island.pop_back();
+		this->islandNext.pop_back();
+		this->owner.pop_back();
+		this->body.pop_back();
+	}
+
+	u32 PhysicsPool::IndexOf(Handle handle) const {
+		return this->bodies.Get(handle);
+	}
+
+	PhysicsComponent PhysicsPool::Get(Handle handle) const {
+		PhysicsComponent result;
+		u32 index = this->IndexOf(handle);
+		if (index != HandleTable::InvalidValue){
+			result.ax = this->ax[index];
+			result.ay = this->ay[index];
+			result.az = this->az[index];
+			result.vx = this->vx[index];
+			result.vy = this->vy[index];
+			result.vz = this->vz[index];
+			result.halfExtents = this->halfExtents[index];
+		}
+		return result;
+	}
+
+	u32 PhysicsPool::Size() const {
+		return (u32) this->body.size();
+	}
+
+	//The constants are per step at ReferenceRate. SetStepLength() scales them by how many reference steps a step covers,
+	//so the simulation runs at the same speed at any physics rate. Damping compounds, so it is a power, and
+	//acceleration is scaled so a body settles at the same terminal speed it reaches at the reference rate.
+
+	void PhysicsPool::SetStepLength(float deltaTime){
+		this->stepLength = deltaTime;
+		this->stepFrames = deltaTime * this->ReferenceRate;
+		this->stepDamping = std::pow(0.2f, this->stepFrames);
+		this->stepAcceleration = (1.0f - this->stepDamping) / (1.0f - 0.2f);
+	}
+
+	void PhysicsPool::Accelerate(TransformPool& transforms, u32 begin, u32 end){
+		const float gravityRamp = (this->GravityY / 30.0f) * this->stepFrames;
+		const float acceleration = this->stepAcceleration;
+
+		//Work on raw array pointers, so the loop is a straight sweep over contiguous memory.
+		const Handle* owner = this->owner.data();
+		float* ax = this->ax.data();
+		float* ay = this->ay.data();
+		float* az = this->az.data();
+		float* vx = this->vx.data();
+		float* vy = this->vy.data();
+		float* vz = this->vz.data();
+		const C3D_FVec* position = transforms.position.data();
+		const Handle* parent = transforms.parent.data();
+
+		const u8* asleep = this->asleep.data();
+
+		for (u32 i = begin; i < end; i++){
+			//Bodies attached to another transform, like a held object, are carried by their parent instead.
+			u32 slot = HandleTable::IndexOf(owner[i]);
+			if (asleep[i] || parent[slot] != InvalidHandle){
+				continue;
+			}
+
+			//Bounce off the ground plane, otherwise keep falling until terminal acceleration.
+			if (position[slot].y < 0.0f) {
+				ay[i] *= -0.8f;
+				vy[i] *= -0.8f;
+				if (std::abs(ay[i]) < std::numeric_limits<float>::epsilon()){
+					ay[i] = 0.0f;
+				}
+			}
+			else if (ay[i] > this->GravityY){
+				ay[i] += gravityRamp;
+			}
+
+			vx[i] += ax[i] * acceleration;
+			vy[i] += ay[i] * acceleration;
+			vz[i] += az[i] * acceleration;
+		}
+	}
+
+	void PhysicsPool::Integrate(TransformPool& transforms, u32 begin, u32 end){
+		const float deltaTime = this->stepLength;
+		const float frames = this->stepFrames;
+		const float damping = this->stepDamping;
+
+		const Handle* owner = this->owner.data();
+		float* vx = this->vx.data();
+		float* vy = this->vy.data();
+		float* vz = this->vz.data();
+		C3D_FVec* position = transforms.position.data();
+		const Handle* parent = transforms.parent.data();
+		u8* flags = transforms.flags.data();
+		const u8* asleep = this->asleep.data();
+		float* restTime = this->restTime.data();
+		const float sleepSpeedSquared = this->SleepSpeed * this->SleepSpeed;
+
+		for (u32 i = begin; i < end; i++){
+			u32 slot = HandleTable::IndexOf(owner[i]);
+			if (asleep[i] || parent[slot] != InvalidHandle){
+				continue;
+			}
+			C3D_FVec& p = position[slot];
+			flags[slot] |= TransformPool::Dirty;
+
+			p.x += vx[i] * frames;
+			p.y += vy[i] * frames;
+			p.z += vz[i] * frames;
+
+			float speedSquared = vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i];
+			restTime[i] = speedSquared < sleepSpeedSquared ? restTime[i] + deltaTime : 0.0f;
+
+			vx[i] *= damping;
+			vy[i] *= damping;
+			vz[i] *= damping;
+		}
+	}
+
+	void PhysicsPool::Sleep(Handle handle, Handle island){
+		u32 index = this->IndexOf(handle);
+		if (index == HandleTable::InvalidValue){
+			return;
+		}
+		this->vx[index] = 0.0f;
+		this->vy[index] = 0.0f;
+		this->vz[index] = 0.0f;
+		if (this->asleep[index]){
+			return;
+		}
+		this->asleep[index] = 1;
+		this->island[index] = island;
+
+		//The ring starts at the body the island is named after, which may only fall asleep after some of the others.
+		//Every other body goes in right after it.
+		u32 root = this->IndexOf(island);
+		if (root == HandleTable::InvalidValue){
+			this->islandNext[index] = handle;
+			return;
+		}
+		if (this->islandNext[root] == InvalidHandle){
+			this->islandNext[root] = island;
+		}
+		if (root != index){
+			this->islandNext[index] = this->islandNext[root];
+			this->islandNext[root] = handle;
+		}
+	}
+
+	void PhysicsPool::Wake(Handle handle){
+		u32 index = this->IndexOf(handle);
+		if (index == HandleTable::InvalidValue){
+			return;
+		}
+		this->restTime[index] = 0.0f;
+		if (!this->asleep[index]){
+			return;
+		}
+
+		//Once around the island's ring.
+		Handle member = handle;
+		do {
+			u32 i = this->IndexOf(member);
+			member = this->islandNext[i];
+			this->asleep[i] = 0;
+			this->restTime[i] = 0.0f;
+			this->island[i] = InvalidHandle;
+			this->islandNext[i] = InvalidHandle;
+		} while (member != handle && member != InvalidHandle);
+	}
+
+	u32 PhysicsPool::SleepingCount() const {
+		u32 count = 0;
+		for (size_t i = 0; i < this->asleep.size(); i++){
+			count += this->asleep[i];
+		}
+		return count;
+	}
+
+	//------------------------------------------------------------------------------------
+
+	ComponentPools& ComponentPools::Instance(){
+		static ComponentPools pools;
+		return pools;
+	}
+
+	Handle ComponentPools::CreateObject(){
+		Handle object = this->objects.Create(HandleTable::InvalidValue);
+		u32 slot = HandleTable::IndexOf(object);
+		if (slot >= this->masks.size()){
+			this->masks.resize(slot + 1, 0);
+			for (u32 type = 0; type < ComponentTypeCount; type++){
+				this->slots[type].resize(slot + 1, InvalidHandle);
+			}
+		}
+
+		//Every game object owns a transform, at its own slot, so the game object handle doubles as the transform's.
+		this->transforms.Create(slot);
+		this->masks[slot] = ComponentTraits<TransformComponent>::Bit;
+		this->slots[ComponentTraits<TransformComponent>::Index][slot] = object;
+		return object;
+	}
+
+	void ComponentPools::Release(Handle object){
+		if (!this->objects.IsValid(object)){
+			return;
+		}
+		u32 slot = HandleTable::IndexOf(object);
+		this->physics.Remove(this->Find<PhysicsComponent>(object));
+		this->transforms.Destroy(slot);
+		this->masks[slot] = 0;
+		for (u32 type = 0; type < ComponentTypeCount; type++){
+			this->slots[type][slot] = InvalidHandle;
+		}
+		this->objects.Destroy(object);
+	}
+
+	u32 ComponentPools::AttachBodies(const Handle* objects, u32 count){
+		u32 first = this->physics.AddBodies(objects, count);
+		for (u32 i = 0; i < count; i++){
+			u32 slot = HandleTable::IndexOf(objects[i]);
+			this->masks[slot] |= ComponentTraits<PhysicsComponent>::Bit;
+			this->slots[ComponentTraits<PhysicsComponent>::Index][slot] = this->physics.body[first + i];
+		}
+		return first;
+	}
+
+	void ComponentPools::Reserve(u32 objectCount, u32 bodyCount){
+		this->masks.reserve(objectCount);
+		for (u32 type = 0; type < ComponentTypeCount; type++){
+			this->slots[type].reserve(objectCount);
+		}
+		this->transforms.Reserve(objectCount);
+		this->physics.Reserve(bodyCount);
+	}
+
+	template<> Handle ComponentPools::Attach<PhysicsComponent>(Handle object, const PhysicsComponent& component){
+		if (!this->objects.IsValid(object)){
+			return InvalidHandle;
+		}
+		Handle body = this->Find<PhysicsComponent>(object);
+		if (body != InvalidHandle){
+			this->physics.Set(body, component);
+			return body;
+		}
+
+		u32 slot = HandleTable::IndexOf(object);
+		body = this->physics.Add(object, component);
+		this->masks[slot] |= ComponentTraits<PhysicsComponent>::Bit;
+		this->slots[ComponentTraits<PhysicsComponent>::Index][slot] = body;
+		return body;
+	}
+
+	template<> Handle ComponentPools::Attach<TransformComponent>(Handle object, const TransformComponent& component){
+		if (!this->objects.IsValid(object)){
+			return InvalidHandle;
+		}
+		this->transforms.Set(HandleTable::IndexOf(object), component);
+		if (component.parent == InvalidHandle || this->objects.IsValid(component.parent)){
+			this->transforms.SetParent(object, component.parent);
+		}
+		return object;
+	}
+
+	template<> PhysicsComponent ComponentPools::Get<PhysicsComponent>(Handle object) const {
+		return this->physics.Get(this->Find<PhysicsComponent>(object));
+	}
+
+	template<> TransformComponent ComponentPools::Get<TransformComponent>(Handle object) const {
+		return this->transforms.Get(HandleTable::IndexOf(object));
+	}
+}
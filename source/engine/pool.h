@@ -0,0 +1,234 @@
+#pragma once
+
+#ifndef POOL_HEADER
+#	define POOL_HEADER
+
+#include "../common.h"
+#include "batchmath.h"
+#include "component.h"
+#include "handle.h"
+
+namespace Entity {
+	//Transform data for every game object, one dense array per attribute. A game object's transform lives
+	//at the slot index of its handle (see HandleTable::IndexOf), so slots are recycled along with the handles.
+	//
+	//Position, rotation and scale are local, relative to the parent's transform, or to the world for transforms
+	//without a parent. Each transform caches its world matrix, and only rebuilds it when it or one of its ancestors
+	//is marked dirty, so objects that do not move cost no matrix math at all.
+	class TransformPool {
+	public:
+		//Bits of flags.
+		static const u8 Alive = 0x1;
+		static const u8 Dirty = 0x2;
+
+		std::vector<C3D_FVec> position;
+		std::vector<C3D_FQuat> rotation;
+		std::vector<C3D_FVec> scale;
+
+		//Position and rotation as of the start of the last physics step. Rendering interpolates from these.
+		std::vector<C3D_FVec> previousPosition;
+		std::vector<C3D_FQuat> previousRotation;
+
+		//Links of the hierarchy, as game object handles. Children of a transform are a list through nextSibling.
+		std::vector<Handle> parent;
+		std::vector<Handle> firstChild;
+		std::vector<Handle> nextSibling;
+
+		//Local to world matrix, as of the last UpdateWorldMatrices().
+		std::vector<C3D_Mtx> world;
+		std::vector<u8> flags;
+
+		//Resets the slot to the origin, with identity rotation and unit scale, and no parent.
+		void Create(u32 id);
+
+		//Frees the slot. Its children become root transforms, keeping their local values as world values.
+		void Destroy(u32 id);
+
+		//Moves the child under another transform, or to the root with InvalidHandle. The local values are kept.
+		//Returns false, and changes nothing, if that would make the child its own ancestor.
+		bool SetParent(Handle child, Handle newParent);
+
+		//Tells the transform its local values changed, so its world matrix and those below it need rebuilding.
+		void MarkDirty(u32 id);
+
+		//Sets the local position and rotation without interpolating from the old ones, e.g. for teleports and cameras.
+		void Place(u32 id, C3D_FVec position, C3D_FQuat rotation);
+
+		//Rebuilds the world matrices of every dirty transform and its descendants, from the local values blended
+		//between the last two physics states. Transforms that are done interpolating stop being dirty.
+		void UpdateWorldMatrices(float alpha);
+
+		//Same, for the root transforms in the slot range [begin, end) only. A hierarchy is only ever reached through its root,
+		//and a range passes over the children in its slots by their parent link alone, so no range reads what another one
+		//writes, and different ranges can be updated on different threads.
+		void UpdateWorldMatrices(float alpha, u32 begin, u32 end);
+
+		//Translation of the cached world matrix.
+		C3D_FVec WorldPosition(u32 id) const;
+
+		//Copies the current positions and rotations into the previous ones.
+		void SaveState();
+
+		//Blends between the previous and current state. An alpha of 1 is the current state.
+		C3D_FVec InterpolatePosition(u32 id, float alpha) const;
+		C3D_FQuat InterpolateRotation(u32 id, float alpha) const;
+		void Set(u32 id, const TransformComponent& component);
+		TransformComponent Get(u32 id) const;
+		u32 Size() const;
+
+		//Makes room for count slots, so creating that many transforms allocates nothing more.
+		void Reserve(u32 count);
+
+	private:
+		void Unlink(u32 id);
+		void UpdateWorldMatrix(u32 id, bool parentChanged, float alpha);
+
+		//Stops the transform being dirty once it is done interpolating, and updates its children. changed tells whether
+		//its world matrix was just rebuilt.
+		void FinishWorldMatrix(u32 id, bool changed, float alpha);
+	};
+
+	//Structure-of-arrays storage for PhysicsComponent. Bodies are packed densely, in no particular order, and
+	//are referred to by body handles that map to their current index. Removing a body moves the last one into its place.
+	class PhysicsPool {
+	public:
+		const float GravityY = -0.4f;
+
+		std::vector<float> ax, ay, az, vx, vy, vz;
+		std::vector<C3D_FVec> halfExtents;
+
+		//Sleep state. Seconds each body has been moving slower than SleepSpeed, whether it is asleep, and the island it fell
+		//asleep with, named after one of its bodies. Sleeping bodies are left alone by Accelerate() and Integrate(), so
+		//their transforms stay clean, until something wakes them.
+		std::vector<float> restTime;
+		std::vector<u8> asleep;
+		std::vector<Handle> island;
+
+		//The next body of the same island, so the bodies of an island form a ring, and waking it only visits its own bodies.
+		//InvalidHandle for bodies in no island.
+		std::vector<Handle> islandNext;
+
+		//The game object each body belongs to, and each body's own handle.
+		std::vector<Handle> owner;
+		std::vector<Handle> body;
+
+		//Adds a body to the game object, and returns its body handle. See ComponentPools::Attach() for overwriting one.
+		Handle Add(Handle object, const PhysicsComponent& component);
+		void Remove(Handle handle);
+
+		//Adds a body to each of the count game objects, with every value zeroed, and returns the index of the first one.
+		//The new bodies take up the indices after it, so their values can be filled in an array at a time, e.g. from a
+		//scene file. See Core::LoadScene().
+		u32 AddBodies(const Handle* objects, u32 count);
+
+		//Makes room for count bodies, so adding that many allocates nothing more.
+		void Reserve(u32 count);
+
+		//Returns the dense index of the body, or HandleTable::InvalidValue.
+		u32 IndexOf(Handle handle) const;
+
+		void Set(Handle handle, const PhysicsComponent& component);
+		PhysicsComponent Get(Handle handle) const;
+		u32 Size() const;
+
+		//Rate the tuning constants below were made for. SetStepLength() scales them to the actual step length.
+		const float ReferenceRate = 60.0f;
+
+		//Sets the length of the steps Accelerate() and Integrate() take, in seconds, and works out the tuning constants
+		//for it, so the steps themselves need no pow(). Defaults to one step at ReferenceRate.
+		void SetStepLength(float deltaTime);
+
+		//The physics system, in two halves, for the bodies in the range [begin, end) only, so collisions can be resolved
+		//in between (see Engine::CollisionWorld). Both step by the length given to SetStepLength(). Accelerate() applies
+		//gravity and the bodies' accelerations to their velocities, and Integrate() moves the transforms by the velocities,
+		//then damps them. Every body only touches its own data and transform, so different ranges can run on different threads.
+		void Accelerate(TransformPool& transforms, u32 begin, u32 end);
+		void Integrate(TransformPool& transforms, u32 begin, u32 end);
+
+		//Speed, in units per step at ReferenceRate, a body has to stay below for SleepTime seconds before it may sleep.
+		//Bodies touching each other only sleep together, as an island, which Engine::CollisionWorld works out.
+		const float SleepSpeed = 0.01f;
+		const float SleepTime = 0.5f;
+
+		//Puts the body to sleep as part of the island, and stops it.
+		void Sleep(Handle handle, Handle island);
+
+		//Wakes the body, along with every body asleep in its island, so nothing is left resting on a body that moved away.
+		void Wake(Handle handle);
+
+		u32 SleepingCount() const;
+
+	private:
+		HandleTable bodies;
+
+		//Step length, the number of steps at ReferenceRate it covers, and the damping and acceleration scale for it.
+		//See SetStepLength().
+		float stepLength = 1.0f / 60.0f;
+		float stepFrames = 1.0f;
+		float stepDamping = 0.2f;
+		float stepAcceleration = 1.0f;
+	};
+
+	//All component pools, and the handle table of the game objects that own them.
+	class ComponentPools {
+	public:
+		//Game object handles. The stored value is owned by Engine::Core, as the index into its game object list.
+		HandleTable objects;
+
+		TransformPool transforms;
+		PhysicsPool physics;
+
+		//Which components each game object has, as a bit per ComponentType, at the game object's slot index.
+		std::vector<ComponentMask> masks;
+
+		//Handle of each game object's component, one table per ComponentType, at the game object's slot index.
+		//Only meaningful where the game object's mask has the bit set.
+		std::vector<Handle> slots[ComponentTypeCount];
+
+		static ComponentPools& Instance();
+
+		//Allocates a game object handle and its transform slot.
+		Handle CreateObject();
+
+		//Removes every component of the game object, and frees its handle.
+		void Release(Handle object);
+
+		//Gives each of the count game objects a body, with PhysicsPool::AddBodies(), and returns the index of the first one.
+		//The game objects must not have bodies yet.
+		u32 AttachBodies(const Handle* objects, u32 count);
+
+		//Makes room for that many game objects and bodies in every pool.
+		void Reserve(u32 objectCount, u32 bodyCount);
+
+		//Copies the component's values into the pool for its type, and returns the component's handle.
+		//If the game object already has a component of that type, its values are overwritten instead.
+		template<typename Derived> Handle Attach(Handle object, const Derived& component);
+		template<typename Derived> Derived Get(Handle object) const;
+
+		//The game object's component mask, or 0 if the handle is stale.
+		ComponentMask MaskOf(Handle object) const {
+			return this->objects.IsValid(object) ? this->masks[HandleTable::IndexOf(object)] : 0;
+		}
+
+		//True if the game object has every component in the mask. A handle check and a bit test.
+		bool HasAll(Handle object, ComponentMask mask) const {
+			return (this->MaskOf(object) & mask) == mask;
+		}
+
+		template<typename Derived> bool Has(Handle object) const {
+			return this->HasAll(object, ComponentTraits<Derived>::Bit);
+		}
+
+		//Returns the handle of the game object's component, or InvalidHandle if it has none.
+		template<typename Derived> Handle Find(Handle object) const {
+			return this->Has<Derived>(object) ? this->slots[ComponentTraits<Derived>::Index][HandleTable::IndexOf(object)] : InvalidHandle;
+		}
+	};
+
+	template<> Handle ComponentPools::Attach<PhysicsComponent>(Handle object, const PhysicsComponent& component);
+	template<> Handle ComponentPools::Attach<TransformComponent>(Handle object, const TransformComponent& component);
+	template<> PhysicsComponent ComponentPools::Get<PhysicsComponent>(Handle object) const;
+	template<> TransformComponent ComponentPools::Get<TransformComponent>(Handle object) const;
+};
+
+#endif
@@ -0,0 +1,125 @@
+#include "profiler.h"
+
+namespace Engine {
+	//Names of the stages, in ProfileStage order, as they appear on the HUD and in CSV headers.
+	static const char* StageNames[(u32) ProfileStage::Count] = { "update", "physics", "bounds", "prepare", "transforms", "cull", "queue", "submit", "sync" };
+
+	static_assert((u32) HudSlot::ProfileSync - (u32) HudSlot::ProfileUpdate + 1 == (u32) ProfileStage::Count, "Every profile stage needs a HUD slot.");
+
+	const u32 Profiler::HistoryFrames;
+	const u32 Profiler::WindowFrames;
+
+	Profiler& Profiler::Instance(){
+		static Profiler profiler;
+		return profiler;
+	}
+
+	float Profiler::TicksToMilliseconds(u64 ticks){
+		return (float) ticks * (1000.0f / (float) SYSCLOCK_ARM11);
+	}
+
+	void Profiler::AddTicks(ProfileStage stage, u64 ticks){
+		this->current.stageTicks[(u32) stage] += (u32) ticks;
+	}
+
+	void Profiler::AddDraws(u32 drawCalls, u32 vertices){
+		this->current.drawCalls += drawCalls;
+		this->current.vertices += vertices;
+	}
+
+	void Profiler::EndFrame(){
+		//The frame runs from one EndFrame() to the next, so it covers everything, including what is not in a stage.
+		u64 tick = svcGetSystemTick();
+		if (this->frameStart != 0){
+			this->current.frameTicks = (u32) (tick - this->frameStart);
+		}
+		this->frameStart = tick;
+		this->current.gpuProcessing = C3D_GetProcessingTime();
+		this->current.gpuDrawing = C3D_GetDrawingTime();
+
+		u32 frame = this->current.frame;
+		this->samples[this->next] = this->current;
+		this->next = (this->next + 1) % HistoryFrames;
+		this->count = std::min(this->count + 1, HistoryFrames);
+
+		//Refreshing the HUD every frame would only mean formatting lines it does not redraw yet.
+		if (frame % (WindowFrames / 4) == 0){
+			this->Show();
+		}
+
+		this->current = ProfileSample();
+		this->current.frame = frame + 1;
+	}
+
+	u32 Profiler::SampleCount() const {
+		return this->count;
+	}
+
+	const ProfileSample& Profiler::Sample(u32 index) const {
+		return this->samples[(this->next + HistoryFrames - this->count + index) % HistoryFrames];
+	}
+
+	bool Profiler::Dump(const char* path) const {
+		FILE* file = std::fopen(path, "w");
+		if (!file){
+			return false;
+		}
+
+		std::fprintf(file, "frame,frame_ms");
+		for (u32 stage = 0; stage < (u32) ProfileStage::Count; stage++){
+			std::fprintf(file, ",%s_ms", StageNames[stage]);
+		}
+		std::fprintf(file, ",gpu_processing_ms,gpu_drawing_ms,draw_calls,vertices\n");
+
+		for (u32 i = 0; i < this->count; i++){
+			const ProfileSample& sample = this->Sample(i);
+			std::fprintf(file, "%u,%.4f", sample.frame, TicksToMilliseconds(sample.frameTicks));
+			for (u32 stage = 0; stage < (u32) ProfileStage::Count; stage++){
+				std::fprintf(file, ",%.4f", TicksToMilliseconds(sample.stageTicks[stage]));
+			}
+			std::fprintf(file, ",%.4f,%.4f,%u,%u\n", sample.gpuProcessing, sample.gpuDrawing, sample.drawCalls, sample.vertices);
+		}
+		return std::fclose(file) == 0;
+	}
+
+	void Profiler::Show() const {
+#ifdef HUD_ENABLED
+		u32 window = std::min(this->count, WindowFrames);
+		if (window == 0){
+			return;
+		}
+
+		//Column 0 is the whole frame, then the stages.
+		const u32 Columns = (u32) ProfileStage::Count + 1;
+		u32 minimum[Columns], maximum[Columns];
+		u64 total[Columns];
+		float gpu = 0.0f;
+		u32 draws = 0, vertices = 0;
+		for (u32 column = 0; column < Columns; column++){
+			minimum[column] = 0xFFFFFFFF;
+			maximum[column] = 0;
+			total[column] = 0;
+		}
+		for (u32 i = this->count - window; i < this->count; i++){
+			const ProfileSample& sample = this->Sample(i);
+			for (u32 column = 0; column < Columns; column++){
+				u32 ticks = column == 0 ? sample.frameTicks : sample.stageTicks[column - 1];
+				minimum[column] = std::min(minimum[column], ticks);
+				maximum[column] = std::max(maximum[column], ticks);
+				total[column] += ticks;
+			}
+			gpu += sample.gpuProcessing + sample.gpuDrawing;
+			draws += sample.drawCalls;
+			vertices += sample.vertices;
+		}
+
+		DebugHud& hud = DebugHud::Instance();
+		for (u32 column = 0; column < Columns; column++){
+			HudSlot slot = (HudSlot) ((u32) HudSlot::ProfileFrame + column);
+			hud.Print(slot, "%-10s %6.2f %6.2f %6.2f ms", column == 0 ? "frame" : StageNames[column - 1],
+				TicksToMilliseconds(minimum[column]), TicksToMilliseconds(total[column] / window), TicksToMilliseconds(maximum[column]));
+		}
+		hud.Print(HudSlot::ProfileGpu, "gpu %5.2f ms  draws %u  verts %u", gpu / window, draws / window, vertices / window);
+#endif
+	}
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#ifndef PROFILER_HEADER
+#	define PROFILER_HEADER
+
+#include "../common.h"
+#include "hud.h"
+
+namespace Engine {
+	//Parts of a frame the profiler times. Stages can nest (Physics is part of Update), so they do not add up to the frame.
+	enum class ProfileStage {
+		Update,
+		Physics,
+		Bounds,
+		Prepare,
+		Transforms,
+		Cull,
+		Queue,
+		Submit,
+		Sync,
+		Count
+	};
+
+	//What one frame cost. CPU times are in system ticks, see SYSCLOCK_ARM11.
+	struct ProfileSample {
+		u32 frame;
+		u32 frameTicks;
+		u32 stageTicks[(u32) ProfileStage::Count];
+		//GPU time of the previous frame, as reported by citro3d, in milliseconds.
+		float gpuProcessing;
+		float gpuDrawing;
+		u32 drawCalls;
+		u32 vertices;
+	};
+
+	//Frame profiler. ProfileScope (or the PROFILE_SCOPE() macro) times a stage, Core counts the draws, and EndFrame()
+	//files the frame away in a ring of the last HistoryFrames frames. From there it goes to the debug HUD, as
+	//min/avg/max over the last WindowFrames frames, and to a CSV file with Dump().
+	//
+	//Times come from svcGetSystemTick(), which the host build backs with std::chrono::steady_clock.
+	class Profiler {
+	public:
+		static const u32 HistoryFrames = 256;
+		static const u32 WindowFrames = 60;
+
+		static Profiler& Instance();
+
+		void AddTicks(ProfileStage stage, u64 ticks);
+		void AddDraws(u32 drawCalls, u32 vertices);
+
+		//Closes the current frame, and starts the next one. Call once per frame, after C3D_FrameEnd().
+		void EndFrame();
+
+		//Samples of recorded frames, oldest first. Only the last HistoryFrames are kept.
+		u32 SampleCount() const;
+		const ProfileSample& Sample(u32 index) const;
+
+		//Writes the recorded frames to a CSV file, times in milliseconds. Returns false if the file cannot be written.
+		bool Dump(const char* path) const;
+
+		static float TicksToMilliseconds(u64 ticks);
+
+	private:
+		ProfileSample samples[HistoryFrames] = {};
+		ProfileSample current = {};
+		u32 next = 0;
+		u32 count = 0;
+		u64 frameStart = 0;
+
+		//Puts the rolling min/avg/max on the debug HUD.
+		void Show() const;
+	};
+
+	//Adds the time between its construction and destruction to a stage.
+	class ProfileScope {
+	public:
+		ProfileScope(ProfileStage stage) : stage(stage), start(svcGetSystemTick()) { }
+
+		~ProfileScope(){
+			Profiler::Instance().AddTicks(this->stage, svcGetSystemTick() - this->start);
+		}
+
+	private:
+		ProfileStage stage;
+		u64 start;
+	};
+};
+
+#define PROFILE_SCOPE(stage) Engine::ProfileScope profileScope##stage(Engine::ProfileStage::stage)
+
+#endif
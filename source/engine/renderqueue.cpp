@@ -0,0 +1,76 @@
+#include "renderqueue.h"
+
+namespace Engine {
+	using Entity::HandleTable;
+	using Entity::InvalidHandle;
+
+	u64 RenderQueue::MakeKey(u8 shader, Handle mesh, u8 material, float depth){
+		//Non-negative floats sort the same as their bit patterns, so the depth goes in as is.
+		if (!(depth > 0.0f)){
+			depth = 0.0f;
+		}
+		u32 depthBits;
+		std::memcpy(&depthBits, &depth, sizeof(depthBits));
+
+		u64 key = (u64) shader << 56;
+		key |= (u64) (HandleTable::IndexOf(mesh) & 0xFFFF) << 40;
+		key |= (u64) material << 32;
+		key |= depthBits;
+		return key;
+	}
+
+	void RenderQueue::Clear(){
+		this->items.clear();
+		this->order.clear();
+	}
+
+	void RenderQueue::Add(GameObject* object, u8 shader, u8 material, float depth, const C3D_Mtx& modelMatrix){
+		DrawItem item;
+		item.object = object;
+		item.mesh = object->DrawnMesh();
+		item.modelMatrix = modelMatrix;
+
+		this->order.push_back(std::make_pair(MakeKey(shader, item.mesh, material, depth), (u32) this->items.size()));
+		this->items.push_back(item);
+	}
+
+	void RenderQueue::Sort(){
+		std::sort(this->order.begin(), this->order.end());
+	}
+
+	void RenderQueue::Submit(int modelLocation){
+		//Only one shader program and one material exist, and Core binds both once per frame. The mesh is the
+		//state that actually changes between draws.
+		Handle boundMesh = InvalidHandle;
+		u32 boundVertices = 0;
+		this->bufferBinds = 0;
+		this->vertices = 0;
+		for (size_t i = 0; i < this->order.size(); i++){
+			DrawItem& item = this->items[this->order[i].second];
+			if (item.mesh != boundMesh){
+				item.object->ConfigureBuffer();
+				boundMesh = item.mesh;
+				this->bufferBinds++;
+
+				const Entity::Mesh* mesh = Entity::MeshRegistry::Instance().Get(boundMesh);
+				boundVertices = mesh ? mesh->indexCount : 0;
+			}
+
+			C3D_FVUnifMtx4x4(GPU_VERTEX_SHADER, modelLocation, &item.modelMatrix);
+			item.object->Render();
+			this->vertices += boundVertices;
+		}
+	}
+
+	u32 RenderQueue::Size() const {
+		return (u32) this->order.size();
+	}
+
+	u32 RenderQueue::BufferBinds() const {
+		return this->bufferBinds;
+	}
+
+	u32 RenderQueue::Vertices() const {
+		return this->vertices;
+	}
+}
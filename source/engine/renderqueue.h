@@ -0,0 +1,52 @@
+#pragma once
+
+#ifndef RENDERQUEUE_HEADER
+#	define RENDERQUEUE_HEADER
+
+#include "../common.h"
+#include "../entity/entity.h"
+
+namespace Engine {
+	using Entity::GameObject;
+	using Entity::Handle;
+
+	//Collects the draws of a frame, sorts them so objects sharing GPU state end up next to each other, and
+	//submits them in that order. State is only set when it differs from the previous draw, so a scene full of
+	//the same mesh binds its vertex buffer once instead of once per object. On the PICA200, every state change
+	//is more command buffer to push, so this is where most of the per-draw cost goes.
+	class RenderQueue {
+	public:
+		//Sort key, most significant first: shader (8 bits), mesh (16 bits), material (8 bits), depth (32 bits).
+		//Depth is the view space distance, so draws sharing all state go front to back for early depth rejection.
+		static u64 MakeKey(u8 shader, Handle mesh, u8 material, float depth);
+
+		void Clear();
+		void Add(GameObject* object, u8 shader, u8 material, float depth, const C3D_Mtx& modelMatrix);
+		void Sort();
+
+		//Draws everything in sorted order, uploading each model matrix to the given uniform location.
+		void Submit(int modelLocation);
+
+		u32 Size() const;
+
+		//Vertex buffer binds done by the last Submit(), and vertices it drew.
+		u32 BufferBinds() const;
+		u32 Vertices() const;
+
+	private:
+		struct DrawItem {
+			GameObject* object;
+			//The mesh at the object's detail level.
+			Handle mesh;
+			C3D_Mtx modelMatrix;
+		};
+
+		//Items stay where they were added, only the small key/index pairs get sorted.
+		std::vector<DrawItem> items;
+		std::vector<std::pair<u64, u32>> order;
+		u32 bufferBinds = 0;
+		u32 vertices = 0;
+	};
+};
+
+#endif
@@ -0,0 +1,65 @@
+#include "scene.h"
+
+namespace Engine {
+	u32 SceneBlobElementSize(SceneBlob blob){
+		switch (blob){
+			case SceneBlob::Meshes:
+				return sizeof(SceneMeshRecord);
+			case SceneBlob::Objects:
+				return sizeof(SceneObjectRecord);
+			case SceneBlob::Positions:
+			case SceneBlob::Scales:
+			case SceneBlob::HalfExtents:
+				return sizeof(C3D_FVec);
+			case SceneBlob::Rotations:
+				return sizeof(C3D_FQuat);
+			case SceneBlob::Asleep:
+				return sizeof(u8);
+			default:
+				//Indices and floats.
+				return sizeof(u32);
+		}
+	}
+
+	u32 SceneBlobCountOf(const SceneFileHeader& header, SceneBlob blob){
+		if (blob == SceneBlob::Meshes){
+			return header.meshCount;
+		}
+		if (blob <= SceneBlob::Scales){
+			return header.objectCount;
+		}
+		return header.bodyCount;
+	}
+
+	u32 LayOutSceneFile(SceneFileHeader& header){
+		std::memcpy(header.magic, SceneFileMagic, sizeof(header.magic));
+		header.version = SceneFileVersion;
+		header.headerSize = sizeof(SceneFileHeader);
+
+		u32 offset = sizeof(SceneFileHeader);
+		for (u32 i = 0; i < SceneBlobCount; i++){
+			SceneBlob blob = (SceneBlob) i;
+			offset = (offset + SceneFileAlignment - 1) & ~(SceneFileAlignment - 1);
+			header.offsets[i] = offset;
+			offset += SceneBlobCountOf(header, blob) * SceneBlobElementSize(blob);
+		}
+		return offset;
+	}
+
+	bool IsCompatibleSceneFile(const SceneFileHeader& header, u32 fileSize){
+		if (std::memcmp(header.magic, SceneFileMagic, sizeof(header.magic)) != 0 || header.version != SceneFileVersion ||
+			header.headerSize != sizeof(SceneFileHeader)){
+			return false;
+		}
+
+		//In 64 bits, so huge counts cannot wrap around to something that fits.
+		for (u32 i = 0; i < SceneBlobCount; i++){
+			SceneBlob blob = (SceneBlob) i;
+			u64 end = (u64) header.offsets[i] + (u64) SceneBlobCountOf(header, blob) * SceneBlobElementSize(blob);
+			if (header.offsets[i] < sizeof(SceneFileHeader) || header.offsets[i] % SceneFileAlignment != 0 || end > fileSize){
+				return false;
+			}
+		}
+		return true;
+	}
+};
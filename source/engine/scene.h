@@ -0,0 +1,113 @@
+#pragma once
+
+#ifndef SCENE_HEADER
+#	define SCENE_HEADER
+
+#include "../common.h"
+
+namespace Engine {
+	//Binary scene files, written by Core::SaveScene() from the live world and read back by Core::LoadScene(). A file is
+	//a SceneFileHeader, followed by the blobs it lists, each starting at a multiple of SceneFileAlignment. Everything is
+	//little endian, like both the 3DS and the hosts.
+	//
+	//The blobs hold one array each, mostly laid out the way the component pools keep them in memory: the transforms'
+	//positions, rotations and scales as C3D_FVec and C3D_FQuat, and the physics bodies' values one array per field.
+	//Every blob is read in one fread() before the world is touched. New bodies always go at the end of the physics pool,
+	//so their arrays are then copied into it whole. Transforms live at their game object's slot, which is wherever the
+	//handle table puts it, so those are copied into place one by one.
+	enum class SceneBlob : u32 {
+		//SceneMeshRecord per mesh, and SceneObjectRecord per game object.
+		Meshes,
+		Objects,
+
+		//Local transform of each game object, as C3D_FVec, C3D_FQuat and C3D_FVec.
+		Positions,
+		Rotations,
+		Scales,
+
+		//Game object of each body, as an index into the objects, then PhysicsPool's arrays of the same names.
+		BodyOwners,
+		AccelerationsX,
+		AccelerationsY,
+		AccelerationsZ,
+		VelocitiesX,
+		VelocitiesY,
+		VelocitiesZ,
+		HalfExtents,
+		RestTimes,
+		Asleep,
+
+		//Island each sleeping body sleeps in, as the index of one of the island's bodies, or SceneNone.
+		Islands
+	};
+
+	static const u32 SceneBlobCount = 16;
+
+	struct SceneFileHeader {
+		char magic[4];
+		u16 version;
+		u16 headerSize;
+
+		u32 meshCount;
+		u32 objectCount;
+		u32 bodyCount;
+
+		//Where each SceneBlob starts in the file, by SceneBlob.
+		u32 offsets[SceneBlobCount];
+	};
+
+	static_assert(sizeof(SceneFileHeader) == 84, "SceneFileHeader is written to files as is.");
+
+	//Mesh a scene's game objects draw. Either a mesh file in the romfs, loaded with MeshRegistry::Load(), or the
+	//built in vertex list.
+	struct SceneMeshRecord {
+		char asset[60];
+		u32 flags;
+	};
+
+	static_assert(sizeof(SceneMeshRecord) == 64, "SceneMeshRecord is written to files as is.");
+
+	struct SceneObjectRecord {
+		//Index into the meshes, or SceneNone.
+		u32 mesh;
+		//Index of the parent game object, SceneCamera for the camera node, or SceneNone for world space.
+		u32 parent;
+		//GameObject flags, as SceneObject bits.
+		u32 flags;
+	};
+
+	static_assert(sizeof(SceneObjectRecord) == 12, "SceneObjectRecord is written to files as is.");
+
+	static const char SceneFileMagic[4] = { 'S', 'C', 'N', 'E' };
+	static const u16 SceneFileVersion = 1;
+	static const u32 SceneFileAlignment = 16;
+
+	//Stands in for a missing index, and for the player's camera node as a parent.
+	static const u32 SceneNone = 0xFFFFFFFF;
+	static const u32 SceneCamera = 0xFFFFFFFE;
+
+	//Bits of SceneMeshRecord::flags.
+	static const u32 SceneMeshBuiltIn = 0x1;
+
+	//Bits of SceneObjectRecord::flags.
+	static const u32 SceneObjectRender = 0x1;
+	static const u32 SceneObjectUpdate = 0x2;
+	static const u32 SceneObjectDebug = 0x4;
+	//In the player's hands. Only ever set on children of the camera node.
+	static const u32 SceneObjectPickedUp = 0x8;
+
+	//Size of one element of the blob.
+	u32 SceneBlobElementSize(SceneBlob blob);
+
+	//Number of elements in the blob, for the counts in the header.
+	u32 SceneBlobCountOf(const SceneFileHeader& header, SceneBlob blob);
+
+	//Fills in the magic, version and header size, and lays the blobs out one after the other for the counts in the
+	//header. Returns the size of the whole file.
+	u32 LayOutSceneFile(SceneFileHeader& header);
+
+	//True if the header is a scene file this build reads, and its blobs fit in fileSize bytes.
+	bool IsCompatibleSceneFile(const SceneFileHeader& header, u32 fileSize);
+};
+
+#endif
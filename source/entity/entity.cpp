@@ -2,127 +2,98 @@
 
 namespace Entity {
 	GameObject::GameObject(const Vertex list[], int size){
-		//Setting array element size.
-		this->listElementSize = size;
-
-		//Setting list size.
-		this->vertexListSize = size * sizeof(Vertex);
+		//Sharing the vertex buffer with every other game object created from the same vertex list.
+		this->mesh = MeshRegistry::Instance().Acquire(list, size);
+		this->Initialize();
+	}
 
-		//Initializing vertex list.
-		//Create vertex buffer objects.
-		this->vertexBuffer = linearAlloc(this->vertexListSize);
-		std::memcpy(this->vertexBuffer, list, this->vertexListSize);
+	GameObject::GameObject(Handle mesh){
+		this->mesh = MeshRegistry::Instance().AddReference(mesh);
+		this->Initialize();
+	}
 
+	void GameObject::Initialize(){
 		//Enabling rendering flag.
 		this->renderFlag = true;
 		//Enabling updating flag.
 		this->updateFlag = true;
 		
 		//Remaining class member initialization.
-		this->position.x = this->position.y = this->position.z = 0.0f;
-		this->scale.x = this->scale.y = this->scale.z = 0.0f;
-		this->rotation = Quat_Identity();
 		this->isPickedUp = false;
 		this->debugFlag = false;
+		this->detailLevel = 0;
+		this->drawnMesh = this->mesh;
 
-		//Entity-Component stuffs.
-		this->components.clear();
+		//Entity-Component stuffs. The transform slot starts at the origin, with identity rotation and unit scale.
+		this->handle = ComponentPools::Instance().CreateObject();
+		this->id = HandleTable::IndexOf(this->handle);
 	}
 	
 	GameObject::~GameObject(){ }
 
-	void GameObject::Update(){
-		for (size_t i = 0; i < this->components.size(); i++){
-			this->components[i]->Update();
-			
-			//Ignore this for now.
-			//this->components[i]->Out();
-		}
-	}
-
 	void GameObject::Render(){
-		if (this->renderFlag) {
-			//Since the entity object uses up the full vertex buffer, we start from the
-			//beginning of the vertex buffer, and go through to the end of it.
-			C3D_DrawArrays(GPU_TRIANGLES, 0, this->listElementSize);
+		const Mesh* mesh = MeshRegistry::Instance().Get(this->DrawnMesh());
+		if (this->renderFlag && mesh) {
+			//The index buffer is a triangle list over the whole vertex buffer.
+			C3D_DrawElements(GPU_TRIANGLES, mesh->indexCount, C3D_UNSIGNED_SHORT, mesh->indexBuffer);
 		}
 	}
 
 	void GameObject::Release(){
-		//Freeing the allocated memory.
-		if (this->vertexBuffer){
-			std::cout << "Freeing allocated memory." << std::endl;
-			linearFree(this->vertexBuffer);
-		}
+		//Dropping our reference to the mesh. The registry frees the vertex buffer once nobody uses it.
+		MeshRegistry::Instance().Release(this->mesh);
+		this->mesh = InvalidHandle;
+		this->drawnMesh = InvalidHandle;
+
+		//Freeing the component pool slots.
+		ComponentPools::Instance().Release(this->handle);
 	}
 
-	void GameObject::RenderUpdate(C3D_FVec cameraPosition, C3D_Mtx& viewMatrix, C3D_Mtx* modelMatrix){
+	void GameObject::RenderUpdate(C3D_Mtx* modelMatrix){
+		TransformPool& transforms = ComponentPools::Instance().transforms;
+		*modelMatrix = transforms.world[this->id];
+
+		//The mesh's positions are packed into integers. Scaling them back to model space is one more scale on the model matrix.
+		//Every detail level is packed on its own, so it has to be the scale of the level being drawn.
+		const Mesh* mesh = MeshRegistry::Instance().Get(this->DrawnMesh());
+		if (mesh){
+			for (int row = 0; row < 3; row++){
+				modelMatrix->r[row].x *= mesh->positionScale;
+				modelMatrix->r[row].y *= mesh->positionScale;
+				modelMatrix->r[row].z *= mesh->positionScale;
+			}
+		}
+
+#ifdef HUD_ENABLED
 		//If Debug Flag is set...
 		if (this->debugFlag){
-			//Orient the object to face the camera when the object is picked up and held in the hands.
-			this->rotation = Quat_MyLookAt(this->position, cameraPosition);
-			
-			//Creating an inverse matrix.
-			C3D_Mtx inverse;
-			Mtx_Copy(&inverse, &viewMatrix);                                           
-			Mtx_Inverse(&inverse);                
-			
-			//Doing the simplified calculations.
-			Mtx_Translate(modelMatrix, 0.0f, 0.0f, -3.0f, true);
-			Mtx_Multiply(modelMatrix, &inverse, modelMatrix);
-			Mtx_Scale(modelMatrix, 0.25f, 0.25f, 0.25f);
-			
-			//Decomposing the model matrix and obtaining the new object positions. See (Matrix Decomposition) for more info.
-			this->position = FVec4_New(modelMatrix->r[0].w, modelMatrix->r[1].w, modelMatrix->r[2].w, 1.0f);
-			
+			//The debug object hangs off the camera, so its parent's world matrix is the inverse of the view matrix.
+			Handle parent = transforms.parent[this->id];
+			if (parent == InvalidHandle){
+				return;
+			}
+			const C3D_Mtx* inverse = &transforms.world[HandleTable::IndexOf(parent)];
+
 			//Raycasting
-			C3D_FVec playerPosition = Extract_CamPos(&inverse);
-			C3D_FVec cameraForward = Extract_CamForward(&inverse);
-			
-			text(19, 0, "                                                               ");
-			std::cout << "Position: " << std::fixed << std::setprecision(2) << playerPosition.x << "  " << playerPosition.y << "  " << playerPosition.z << std::endl;
-			std::cout << "Forward : " << std::fixed << std::setprecision(2) << cameraForward.x << "  " << cameraForward.y << "  " << cameraForward.z << std::endl;
-			
-			//We do not do anything after debugging.
-			return;
-		}
-		
-		//3D object pick-up.
-		if (this->isPickedUp){
-			//If true, allow the player to manipulate the object in the world.
+			C3D_FVec playerPosition = Extract_CamPos(inverse);
+			C3D_FVec cameraForward = Extract_CamForward(inverse);
 			
-			//Orient the object to face the camera when the object is picked up and held in the hands.
-			this->rotation = Quat_MyLookAt(this->position, cameraPosition);
-			
-			//Creating an inverse matrix.
-			C3D_Mtx inverse;
-			Mtx_Copy(&inverse, &viewMatrix);                                           
-			Mtx_Inverse(&inverse);                
-			
-			//Doing the simplified calculations.
-			Mtx_Translate(modelMatrix, 0.0f, 0.0f, -3.0f, true);
-			Mtx_Multiply(modelMatrix, &inverse, modelMatrix);
-			
-			//Decomposing the model matrix and obtaining the new object positions. See (Matrix Decomposition) for more info.
-			this->position = FVec4_New(modelMatrix->r[0].w, modelMatrix->r[1].w, modelMatrix->r[2].w, 1.0f);
-		}
-		else {
-			//If false, keep its new position and rotation in the world and go from there.
-			Mtx_Translate(modelMatrix, this->position.x, this->position.y, this->position.z, true);
-			C3D_Mtx rotationMatrix;
-			Mtx_FromQuat(&rotationMatrix, this->rotation);
-			
-			//We multiply the model matrix with the rotation matrix, so model matrix will have the new rotation/orientation set.
-			Mtx_Multiply(modelMatrix, modelMatrix, &rotationMatrix);
+			HUD_PRINT(CameraPosition, "Position: %.2f  %.2f  %.2f", playerPosition.x, playerPosition.y, playerPosition.z);
+			HUD_PRINT(CameraForward, "Forward : %.2f  %.2f  %.2f", cameraForward.x, cameraForward.y, cameraForward.z);
 		}
+#endif
 	}
 
 	void GameObject::ConfigureBuffer(){
 		//Initialize and configure buffers.
 		//The Buffer Info needs to be reset every time a new buffer is to take its place.
 		//In other words, BufInfo_Init() is frequently used.
+		const Mesh* mesh = MeshRegistry::Instance().Get(this->DrawnMesh());
+		if (!mesh){
+			return;
+		}
 		C3D_BufInfo* bufferInfo = C3D_GetBufInfo();
 		BufInfo_Init(bufferInfo);
-		BufInfo_Add(bufferInfo, this->vertexBuffer, sizeof(Vertex), 3, 0x210);
+		BufInfo_Add(bufferInfo, mesh->vertexBuffer, mesh->stride, 3, 0x210);
 	}
 }
@@ -5,63 +5,103 @@
 
 #include "../common.h"
 #include "../engine/component.h"
+#include "../engine/hud.h"
+#include "../engine/pool.h"
+#include "../engine/mesh.h"
 
 namespace Entity {
-	class Component;
-	
 	class GameObject {
 	public:
 		bool renderFlag;
 		bool updateFlag;
 		bool isPickedUp;
 		bool debugFlag;
-		void* vertexBuffer;
-		C3D_FVec position;
-		C3D_FVec scale;
-		C3D_FQuat rotation;
-		u32 vertexListSize, listElementSize;
-		std::vector<std::shared_ptr<Component>> components;
-		
+
+		//Shared mesh this game object draws. See mesh.h.
+		Handle mesh;
+
+		//Detail level of the mesh it is drawn at, picked by Core once per frame from its size on the screen. 0 is the mesh
+		//itself. Change it with SetDetailLevel(), which also looks up the mesh to draw for it.
+		u32 detailLevel;
+
+		//Handle of this game object, and its slot index in the component pools. See pool.h.
+		Handle handle;
+		u32 id;
+
 		GameObject(const Vertex list[], int size);
-		
+		//Draws an already registered mesh. Adds a reference to it, so spawning copies of a mesh allocates no linear memory.
+		GameObject(Handle mesh);
+
 		virtual ~GameObject();
-		virtual void Update();
 		virtual void Render();
 		void Release();
-		void RenderUpdate(C3D_FVec cameraPosition, C3D_Mtx& viewMatrix, C3D_Mtx* modelMatrix);
+		//Fetches the model matrix, which is the transform's cached world matrix. See TransformPool::UpdateWorldMatrices().
+		void RenderUpdate(C3D_Mtx* modelMatrix);
 		void ConfigureBuffer();
-		
+
+		//The mesh, or the coarser version of it drawn at the current detail level.
+		Handle DrawnMesh() const {
+			return this->drawnMesh;
+		}
+
+		void SetDetailLevel(u32 level){
+			//Levels are only ever added to a mesh, so the mesh for the current level stays the same.
+			if (level != this->detailLevel){
+				this->detailLevel = level;
+				this->drawnMesh = MeshRegistry::Instance().DetailMesh(this->mesh, level);
+			}
+		}
+
+		//Transform data lives in the transform pool, local to the parent transform if there is one. The references are only
+		//valid until another game object is created. Handing one out marks the transform dirty, since it may get written to.
+		C3D_FVec& Position() {
+			TransformPool& transforms = ComponentPools::Instance().transforms;
+			transforms.MarkDirty(this->id);
+			return transforms.position[this->id];
+		}
+
+		C3D_FQuat& Rotation() {
+			TransformPool& transforms = ComponentPools::Instance().transforms;
+			transforms.MarkDirty(this->id);
+			return transforms.rotation[this->id];
+		}
+
+		C3D_FVec& Scale() {
+			TransformPool& transforms = ComponentPools::Instance().transforms;
+			transforms.MarkDirty(this->id);
+			return transforms.scale[this->id];
+		}
+
+		//Position in world space, as of the last time the world matrices were updated.
+		C3D_FVec WorldPosition() const {
+			return ComponentPools::Instance().transforms.WorldPosition(this->id);
+		}
+
 		//Templates must go inside header files. This is the recommended method in C++.
 
-		template<typename Derived> std::shared_ptr<Derived> AddComponent(){
+		//Returns the handle of the new component.
+		template<typename Derived, typename... TArgs> Handle AddComponent(TArgs&&... args){
 			static_assert(std::is_base_of<Component, Derived>::value, "Derived class is not subclass of Component.");
-			std::shared_ptr<Derived> result(new Derived());
-			result->SetParent(this);
-			result->Initialize();
-			this->components.push_back(result);
-			return result;
+			return ComponentPools::Instance().Attach<Derived>(this->handle, Derived(args...));
 		}
-		
-		template<typename Derived, typename... TArgs> std::shared_ptr<Derived> AddComponent(TArgs&&... args){
+
+		//Constant time, a bit test on the game object's component mask. See ComponentTraits.
+		template<typename Derived> bool HasComponent() {
 			static_assert(std::is_base_of<Component, Derived>::value, "Derived class is not subclass of Component.");
-			std::shared_ptr<Derived> result(new Derived(args...));
-			result->SetParent(this);
-			result->Initialize();
-			this->components.push_back(result);
-			return result;
+			return ComponentPools::Instance().Has<Derived>(this->handle);
 		}
-		
-		//Returns shared pointer to a subclass of Component if found. Returns nullptr if not.
-		template<typename Derived> std::shared_ptr<Derived> GetComponent() {
+
+		//Returns a copy of the component's values, gathered from its pool. Check HasComponent<T>() first.
+		template<typename Derived> Derived GetComponent() {
 			static_assert(std::is_base_of<Component, Derived>::value, "Derived class is not subclass of Component.");
-			for (size_t i = 0; i < this->components.size(); i++){
-				Derived* result = static_cast<Derived*>(this->components[i].get());
-				if (result){
-					return std::static_pointer_cast<Derived>(this->components[i]);	
-				}
-			}
-			return nullptr;
+			return ComponentPools::Instance().Get<Derived>(this->handle);
 		}
+
+	private:
+		Handle drawnMesh;
+
+		//Shared by both constructors, once the mesh is set.
+		void Initialize();
 	};
 };
 
@@ -14,10 +14,10 @@ namespace Entity {
 		this->oldTouchY = 0;
 		this->touchX = this->oldTouchX; 
 		this->touchY = this->oldTouchY;
-		this->counter = 0;
 		this->inversePitchFlag = false;
 		this->cameraManipulateFlag = false;
-		this->inHands = nullptr;
+		this->inHands = InvalidHandle;
+		this->cameraNode = ComponentPools::Instance().CreateObject();
 	}
 
 	void Player::Update(u32 keyDown, u32 keyHeld, u32 keyUp, touchPosition touchInput){
@@ -27,11 +27,11 @@ namespace Entity {
 		if (keyHeld & KEY_L) {
 			if (keyHeld & KEY_LEFT) {
 				this->rotationYaw -= radian;
-				this->rotationYaw = std::fmod(this->rotationYaw, degToRad(360.0f));
+				this->rotationYaw = FastMath::Fmod(this->rotationYaw, degToRad(360.0f));
 			}
 			else if (keyHeld & KEY_RIGHT) {
 				this->rotationYaw += radian;
-				this->rotationYaw = std::fmod(this->rotationYaw, degToRad(360.0f));
+				this->rotationYaw = FastMath::Fmod(this->rotationYaw, degToRad(360.0f));
 			}
 			else if (keyHeld & KEY_UP) {
 				if (this->inversePitchFlag){
@@ -68,21 +68,23 @@ namespace Entity {
 			//Cartesian coordinates, X, and Z axes.
 			//Note strafing reverses the ordering of cosine and sine calculations, because
 			//The cosine and sine calculations are rotated by 90 degrees counterclockwise.
+			float yawSine, yawCosine;
+			FastMath::SinCos(this->rotationYaw, yawSine, yawCosine);
 			if (keyHeld & KEY_UP) {
-				this->cameraPosition.x += std::sin(this->rotationYaw) * this->speed;
-				this->cameraPosition.z -= std::cos(this->rotationYaw) * this->speed;
+				this->cameraPosition.x += yawSine * this->speed;
+				this->cameraPosition.z -= yawCosine * this->speed;
 			}
 			else if (keyHeld & KEY_DOWN) {
-				this->cameraPosition.x -= std::sin(this->rotationYaw) * this->speed;
-				this->cameraPosition.z += std::cos(this->rotationYaw) * this->speed;
+				this->cameraPosition.x -= yawSine * this->speed;
+				this->cameraPosition.z += yawCosine * this->speed;
 			}
 			else if (keyHeld & KEY_LEFT) {
-				this->cameraPosition.x -= std::cos(this->rotationYaw) * this->speed;
-				this->cameraPosition.z -= std::sin(this->rotationYaw) * this->speed;
+				this->cameraPosition.x -= yawCosine * this->speed;
+				this->cameraPosition.z -= yawSine * this->speed;
 			}
 			else if (keyHeld & KEY_RIGHT) {
-				this->cameraPosition.x += std::cos(this->rotationYaw) * this->speed;
-				this->cameraPosition.z += std::sin(this->rotationYaw) * this->speed;
+				this->cameraPosition.x += yawCosine * this->speed;
+				this->cameraPosition.z += yawSine * this->speed;
 			}
 
 			//Touchscreen cursor sensitivity. May need tweaking.
@@ -111,15 +113,12 @@ namespace Entity {
 				f = std::max<float>(-89.9f, std::min<float>(f, 89.9f));
 				this->rotationPitch = degToRad(f);
 				
-				text(8, 0, "                   ");
-				text(8, 0, "Pitch: " + ToString(f));
+				HUD_PRINT(Pitch, "Pitch: %.2f", f);
 				
-				
-				f = std::fmod(((((float) (this->offsetTouchY + this->touchY) * sensitivity / 65536.0f) * 360.0f) - 180.0f), 360.0f) - 180.0f;
+				f = FastMath::Fmod(((((float) (this->offsetTouchY + this->touchY) * sensitivity / 65536.0f) * 360.0f) - 180.0f), 360.0f) - 180.0f;
 				this->rotationYaw = degToRad(f);
 
-				text(9, 0, "                   ");
-				text(9, 0, "Yaw: " + ToString(f));
+				HUD_PRINT(Yaw, "Yaw: %.2f", f);
 			}
 			else if (keyUp & KEY_TOUCH) {
 				//Adding offset to the main touch coordinates.
@@ -136,14 +135,12 @@ namespace Entity {
 				this->rotationPitch = degToRad(f);
 				this->touchX = std::max<float>(-127, std::min<float>(this->touchX, 127)); //Magic number. This resets the pitch offset value to the min/max dragging value.
 				
-				text(8, 0, "                   ");
-				text(8, 0, "Pitch: " + ToString(f));
+				HUD_PRINT(Pitch, "Pitch: %.2f", f);
 				
-				f = std::fmod(((((float) this->touchY * sensitivity / 65536.0f) * 360.0f) - 180.0f), 360.0f) - 180.0f;
+				f = FastMath::Fmod(((((float) this->touchY * sensitivity / 65536.0f) * 360.0f) - 180.0f), 360.0f) - 180.0f;
 				this->rotationYaw = degToRad(f);
 				
-				text(9, 0, "                   ");
-				text(9, 0, "Yaw: " + ToString(f));
+				HUD_PRINT(Yaw, "Yaw: %.2f", f);
 			}
 		}
 
@@ -159,10 +156,10 @@ namespace Entity {
 		if (keyDown & KEY_X){
 			this->inversePitchFlag = !this->inversePitchFlag;
 			if (this->inversePitchFlag){
-				text(20, 0, "Inverse Pitch is enabled.");
+				HUD_PRINT(InversePitch, "Inverse Pitch is enabled.");
 			}
 			else {
-				text(20, 0, "                              ");
+				HUD_CLEAR(InversePitch);
 			}
 		}
 		
@@ -174,23 +171,17 @@ namespace Entity {
 			this->cameraManipulateFlag = false;
 		}
 		
-		this->counter++;
-		if (this->counter > 50){
-			//This is done to clear up the console output screen.
-			text(10, 0, "                                     ");
-			text(11, 0, "                                     ");
-			text(12, 0, "                                     ");
-			text(10, 0, "Touch Coordinates: " + ToString(this->touchX) + "  " + ToString(this->touchY));
-			text(11, 0, "Old Touches: " + ToString(this->oldTouchX) + "  " + ToString(this->oldTouchY));
-			text(12, 0, "Yaw: " + ToString(this->rotationYaw) + "   Pitch: " + ToString(this->rotationPitch));
-			this->counter = 0;
-		}
+		//The HUD only redraws lines that changed, a few times a second, so these can be updated every frame.
+		HUD_PRINT(TouchCoordinates, "Touch Coordinates: %d  %d", this->touchX, this->touchY);
+		HUD_PRINT(OldTouches, "Old Touches: %d  %d", this->oldTouchX, this->oldTouchY);
+		HUD_PRINT(Angles, "Yaw: %.4f   Pitch: %.4f", this->rotationYaw, this->rotationPitch);
 	}
 
 	void Player::RenderUpdate(C3D_Mtx* viewMatrix){
 		//Creating the rotation matrix from pitch, yaw, and roll values, with roll set to 0.0f for FPS camera.
+		C3D_FQuat rotation = Quat_MyPitchYawRoll(this->rotationPitch, this->rotationYaw, 0.0f, false);
 		C3D_Mtx rotationMatrix;
-		Mtx_FromQuat(&rotationMatrix, Quat_MyPitchYawRoll(this->rotationPitch, this->rotationYaw, 0.0f, false));
+		Mtx_FromQuat(&rotationMatrix, rotation);
 		
 		//Applying the rotation matrix to the view matrix by matrix multiplication on the right hand side.
 		Mtx_Identity(viewMatrix);
@@ -199,10 +190,14 @@ namespace Entity {
 		//The bRightSide parameter at the end is mostly because we're doing multiplication as  (viewMatrix * cameraPosition). bRightSide refers to
 		//placing the factor (cameraPosition) on the right side of the product (viewMatrix), literally.
 		Mtx_Translate(viewMatrix, -this->cameraPosition.x, 0.0f, -this->cameraPosition.z, true);
+
+		//The camera node does the opposite of the view matrix: rotates by the inverse rotation, then moves to the camera.
+		TransformPool& transforms = ComponentPools::Instance().transforms;
+		transforms.Place(HandleTable::IndexOf(this->cameraNode), FVec4_New(this->cameraPosition.x, 0.0f, this->cameraPosition.z, 1.0f), Quat_Conjugate(rotation));
 	}
 	
 	bool Player::CheckDistance(GameObject* entity, const float threshold){
-		float distance = FVec4_Magnitude(FVec4_Subtract(entity->position, this->cameraPosition));
+		float distance = FVec4_Magnitude(FVec4_Subtract(entity->Position(), this->cameraPosition));
 		return threshold > distance;
 	}
 };
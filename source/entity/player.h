@@ -16,13 +16,16 @@ namespace Entity {
 		float rotationPitch, rotationYaw;
 		float speed;
 		s16 touchX, touchY, oldTouchX, oldTouchY, offsetTouchX, offsetTouchY;
-		u16 counter;
 		C3D_FVec cameraPosition;
-		std::shared_ptr<GameObject> inHands;
+		Handle inHands;
+
+		//Transform following the camera, so objects can be attached to it. Its world matrix is the inverse of the view matrix.
+		Handle cameraNode;
 
 		Player();
 		bool CheckDistance(GameObject* entity, const float threshold);
 		void Update(u32 downKey, u32 heldKey, u32 upKey, touchPosition touchInput);
+		//Builds the view matrix, and moves the camera node along.
 		void RenderUpdate(C3D_Mtx* viewMatrix);
 		
 	};
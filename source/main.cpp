@@ -19,30 +19,59 @@ typedef SSIZE_T ssize_t;
 
 int main(){
 	gfxInitDefault();
+	romfsInit();
 	PrintConsole output;
 	consoleSelect(consoleInit(GFX_BOTTOM, &output));
 
 	Engine::Core& core = Engine::Core::Instance();
 	core.Initialize();
 
-	u32 down, held, up;
-	touchPosition touchInput;
+	//Hold R while starting to record this session's input, or L to replay the last recording. Holding both replays it
+	//as fast as the GPU allows. See Engine::InputLog.
+	const char* inputLogPath = "sdmc:/homebrew-input.bin";
+	Engine::InputLog inputLog;
+	hidScanInput();
+	u32 startKeys = hidKeysHeld();
+	if (startKeys & KEY_L){
+		if (inputLog.StartReplay(inputLogPath)){
+			core.SetFrameSync(!(startKeys & KEY_R));
+		}
+	}
+	else if (startKeys & KEY_R){
+		inputLog.StartRecording(inputLogPath);
+	}
+
+	Engine::InputState input;
 
 	while (aptMainLoop()){
 		hidScanInput();
-		down = hidKeysDown();
-		held = hidKeysHeld();
-		up = hidKeysUp();
-		hidTouchRead(&touchInput);
-		if (down & KEY_START){
+		input.down = hidKeysDown();
+		input.held = hidKeysHeld();
+		input.up = hidKeysUp();
+		hidTouchRead(&input.touch);
+		input.deltaTime = core.MeasureFrameTime();
+		input.slider = osGet3DSliderState();
+		if (input.down & KEY_START){
 			break;
 		}
+		//Saves the last few seconds of frame timings, see Engine::Profiler.
+		if (input.down & KEY_SELECT){
+			Engine::Profiler::Instance().Dump("sdmc:/homebrew-profile.csv");
+		}
+
+		//A finished replay leaves its timings behind, and hands control back.
+		if (!inputLog.Process(input)){
+			Engine::Profiler::Instance().Dump("sdmc:/homebrew-profile.csv");
+			core.SetFrameSync(true);
+		}
 
-		core.Update(down, held, up, touchInput);
-		core.Render();
+		core.Update(input.down, input.held, input.up, input.touch, input.deltaTime);
+		core.Render(input.slider);
 	}
 
+	inputLog.Stop();
 	core.Release();
+	romfsExit();
 	gfxExit();
 	return 0;
 }
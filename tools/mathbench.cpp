@@ -0,0 +1,130 @@
+//Checks the batched math kernels (see source/engine/batchmath.h) against their scalar reference, and times both.
+//
+//  mathbench [count] [rounds]
+//
+//Runs every kernel over count random objects (default 2000), rounds times (default 200), and prints the time per object
+//of each backend, the speedup, and the largest difference from the reference. Built by "make host-tools". Build with
+//HOST_CXXFLAGS+=-DBATCHMATH_SCALAR to time the reference against itself.
+
+#include "../source/engine/batchmath.h"
+
+#include <chrono>
+
+using namespace Engine;
+
+namespace {
+	//Small xorshift generator, so every run uses the same inputs.
+	u32 state = 2463534242u;
+
+	float Random(float minimum, float maximum){
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return minimum + (maximum - minimum) * (float) (state & 0xFFFFFF) / (float) 0xFFFFFF;
+	}
+
+	C3D_FVec RandomVector(float minimum, float maximum){
+		return FVec4_New(Random(minimum, maximum), Random(minimum, maximum), Random(minimum, maximum), 1.0f);
+	}
+
+	C3D_FQuat RandomRotation(){
+		C3D_FQuat q = Quat_New(Random(-1.0f, 1.0f), Random(-1.0f, 1.0f), Random(-1.0f, 1.0f), Random(-1.0f, 1.0f));
+		return Quat_Normalize(q);
+	}
+
+	//Largest difference between two float arrays.
+	float Difference(const float* a, const float* b, size_t count){
+		float largest = 0.0f;
+		for (size_t i = 0; i < count; i++){
+			largest = std::max(largest, std::abs(a[i] - b[i]));
+		}
+		return largest;
+	}
+
+	//Nanoseconds per object, of the best of rounds runs.
+	template<typename Function> double Time(u32 count, u32 rounds, Function function){
+		double best = 1e30;
+		for (u32 round = 0; round < rounds; round++){
+			auto start = std::chrono::steady_clock::now();
+			function();
+			std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+			best = std::min(best, elapsed.count());
+		}
+		return best / count;
+	}
+
+	void Report(const char* name, double reference, double fast, float difference){
+		std::printf("%-18s %8.2f %8.2f %7.2fx %12g\n", name, reference, fast, reference / fast, difference);
+	}
+}
+
+int main(int argc, char** argv){
+	u32 count = argc > 1 ? (u32) std::atoi(argv[1]) : 2000;
+	u32 rounds = argc > 2 ? (u32) std::atoi(argv[2]) : 200;
+	if (count == 0 || rounds == 0){
+		std::fprintf(stderr, "Usage: %s [count] [rounds]\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<C3D_FVec> positions(count), scales(count);
+	std::vector<C3D_FQuat> rotations(count);
+	std::vector<C3D_Mtx> matrices(count), reference(count), fast(count);
+	std::vector<float> referenceDistances(count), fastDistances(count);
+	for (u32 i = 0; i < count; i++){
+		positions[i] = RandomVector(-100.0f, 100.0f);
+		scales[i] = RandomVector(0.25f, 4.0f);
+		rotations[i] = RandomRotation();
+	}
+	BatchMath::Scalar::ComposeMatrices(matrices.data(), positions.data(), rotations.data(), scales.data(), count);
+
+	C3D_Mtx view;
+	Mtx_Identity(&view);
+	Mtx_RotateY(&view, 0.7f, true);
+	Mtx_Translate(&view, -3.0f, -1.5f, 8.0f, true);
+	C3D_FVec camera = FVec3_New(3.0f, 1.5f, -8.0f);
+
+	std::printf("backend %s, %u objects, best of %u rounds\n", BatchMath::Backend(), count, rounds);
+	std::printf("%-18s %8s %8s %8s %12s\n", "kernel", "ref ns", "fast ns", "speedup", "max error");
+
+	double referenceTime = Time(count, rounds, [&](){
+		BatchMath::Scalar::ComposeMatrices(reference.data(), positions.data(), rotations.data(), scales.data(), count);
+	});
+	double fastTime = Time(count, rounds, [&](){
+		BatchMath::ComposeMatrices(fast.data(), positions.data(), rotations.data(), scales.data(), count);
+	});
+	Report("ComposeMatrices", referenceTime, fastTime, Difference(reference[0].m, fast[0].m, count * 16));
+
+	referenceTime = Time(count, rounds, [&](){
+		BatchMath::Scalar::MultiplyMatrices(reference.data(), view, matrices.data(), count);
+	});
+	fastTime = Time(count, rounds, [&](){
+		BatchMath::MultiplyMatrices(fast.data(), view, matrices.data(), count);
+	});
+	Report("MultiplyMatrices", referenceTime, fastTime, Difference(reference[0].m, fast[0].m, count * 16));
+
+	//One Mtx_Multiply() per object, the way the engine multiplied matrices before.
+	double singleTime = Time(count, rounds, [&](){
+		for (u32 i = 0; i < count; i++){
+			Mtx_Multiply(&reference[i], &view, &matrices[i]);
+		}
+	});
+	Report("Mtx_Multiply loop", singleTime, fastTime, Difference(reference[0].m, fast[0].m, count * 16));
+
+	referenceTime = Time(count, rounds, [&](){
+		BatchMath::Scalar::Distances(referenceDistances.data(), positions.data(), count, camera);
+	});
+	fastTime = Time(count, rounds, [&](){
+		BatchMath::Distances(fastDistances.data(), positions.data(), count, camera);
+	});
+	Report("Distances", referenceTime, fastTime, Difference(referenceDistances.data(), fastDistances.data(), count));
+
+	C3D_FVec plane = FVec4_Negate(view.r[2]);
+	referenceTime = Time(count, rounds, [&](){
+		BatchMath::Scalar::PlaneDistances(referenceDistances.data(), positions.data(), count, plane);
+	});
+	fastTime = Time(count, rounds, [&](){
+		BatchMath::PlaneDistances(fastDistances.data(), positions.data(), count, plane);
+	});
+	Report("PlaneDistances", referenceTime, fastTime, Difference(referenceDistances.data(), fastDistances.data(), count));
+	return 0;
+}
@@ -0,0 +1,314 @@
+//Converts Wavefront OBJ meshes to the engine's binary mesh format (see source/engine/meshformat.h).
+//
+//  meshconv input.obj output.mesh
+//
+//Faces are triangulated as fans, vertices are packed and deduplicated exactly like MeshRegistry::Acquire() does at run
+//time, and the triangles are reordered for the post-transform vertex cache (Tom Forsyth's linear-speed vertex cache
+//optimisation). Vertices are then renumbered in the order the triangles first use them, so fetches walk forward
+//through memory. Built by "make host-tools", and run over assets/ by "make host-assets".
+
+#include "../source/engine/meshformat.h"
+
+using namespace Entity;
+
+namespace {
+	//Looks up an OBJ index, which counts from 1, or backwards from the end when negative.
+	int ResolveIndex(int index, size_t count){
+		return index < 0 ? (int) count + index : index - 1;
+	}
+
+	bool LoadObj(const char* path, std::vector<Vertex>& triangles){
+		FILE* file = std::fopen(path, "r");
+		if (!file){
+			std::fprintf(stderr, "Cannot open %s\n", path);
+			return false;
+		}
+
+		std::vector<C3D_FVec> positions, texcoords, normals;
+		char line[1024];
+		int lineNumber = 0;
+		while (std::fgets(line, sizeof(line), file)){
+			lineNumber++;
+			float x = 0.0f, y = 0.0f, z = 0.0f;
+			if (std::strncmp(line, "v ", 2) == 0){
+				std::sscanf(line + 2, "%f %f %f", &x, &y, &z);
+				positions.push_back(FVec3_New(x, y, z));
+			}
+			else if (std::strncmp(line, "vt ", 3) == 0){
+				std::sscanf(line + 3, "%f %f", &x, &y);
+				texcoords.push_back(FVec3_New(x, y, 0.0f));
+			}
+			else if (std::strncmp(line, "vn ", 3) == 0){
+				std::sscanf(line + 3, "%f %f %f", &x, &y, &z);
+				normals.push_back(FVec3_Normalize(FVec3_New(x, y, z)));
+			}
+			else if (std::strncmp(line, "f ", 2) == 0){
+				//Corners are v, v/vt, v//vn or v/vt/vn.
+				std::vector<Vertex> face;
+				std::vector<bool> hasNormal;
+				std::istringstream corners(line + 2);
+				std::string corner;
+				while (corners >> corner){
+					int v = 0, vt = 0, vn = 0;
+					if (std::sscanf(corner.c_str(), "%d/%d/%d", &v, &vt, &vn) != 3 &&
+						std::sscanf(corner.c_str(), "%d//%d", &v, &vn) != 2 &&
+						std::sscanf(corner.c_str(), "%d/%d", &v, &vt) != 2){
+						std::sscanf(corner.c_str(), "%d", &v);
+					}
+
+					int p = ResolveIndex(v, positions.size());
+					int t = vt ? ResolveIndex(vt, texcoords.size()) : -1;
+					int n = vn ? ResolveIndex(vn, normals.size()) : -1;
+					if (p < 0 || p >= (int) positions.size() || t >= (int) texcoords.size() || n >= (int) normals.size()){
+						std::fprintf(stderr, "%s:%d: index out of range\n", path, lineNumber);
+						std::fclose(file);
+						return false;
+					}
+
+					Vertex vertex;
+					std::memset(&vertex, 0, sizeof(vertex));
+					vertex.positions[0] = positions[p].x;
+					vertex.positions[1] = positions[p].y;
+					vertex.positions[2] = positions[p].z;
+					if (t >= 0){
+						vertex.texcoords[0] = texcoords[t].x;
+						vertex.texcoords[1] = texcoords[t].y;
+					}
+					if (n >= 0){
+						vertex.normals[0] = normals[n].x;
+						vertex.normals[1] = normals[n].y;
+						vertex.normals[2] = normals[n].z;
+					}
+					face.push_back(vertex);
+					hasNormal.push_back(n >= 0);
+				}
+
+				for (size_t i = 2; i < face.size(); i++){
+					Vertex triangle[3] = { face[0], face[i - 1], face[i] };
+
+					//Corners without a normal get the flat normal of their triangle.
+					C3D_FVec a = FVec3_New(triangle[0].positions[0], triangle[0].positions[1], triangle[0].positions[2]);
+					C3D_FVec b = FVec3_New(triangle[1].positions[0], triangle[1].positions[1], triangle[1].positions[2]);
+					C3D_FVec c = FVec3_New(triangle[2].positions[0], triangle[2].positions[1], triangle[2].positions[2]);
+					C3D_FVec flat = FVec3_Cross(FVec3_Subtract(b, a), FVec3_Subtract(c, a));
+					if (FVec3_Magnitude(flat) > 0.0f){
+						flat = FVec3_Normalize(flat);
+					}
+					const size_t corner[3] = { 0, i - 1, i };
+					for (int k = 0; k < 3; k++){
+						if (!hasNormal[corner[k]]){
+							triangle[k].normals[0] = flat.x;
+							triangle[k].normals[1] = flat.y;
+							triangle[k].normals[2] = flat.z;
+						}
+						triangles.push_back(triangle[k]);
+					}
+				}
+			}
+		}
+		std::fclose(file);
+		return true;
+	}
+
+	//Average cache miss ratio: vertices transformed per triangle, through a FIFO cache of the given size.
+	float CacheMissRatio(const std::vector<u16>& indices, size_t cacheSize){
+		std::vector<int> cache;
+		u32 misses = 0;
+		for (size_t i = 0; i < indices.size(); i++){
+			if (std::find(cache.begin(), cache.end(), indices[i]) == cache.end()){
+				misses++;
+				cache.push_back(indices[i]);
+				if (cache.size() > cacheSize){
+					cache.erase(cache.begin());
+				}
+			}
+		}
+		return indices.empty() ? 0.0f : (float) misses / (float) (indices.size() / 3);
+	}
+
+	//Tom Forsyth, "Linear-Speed Vertex Cache Optimisation". Greedily emits the triangle whose vertices score best,
+	//scoring vertices by how recently they were used and by how few triangles still need them.
+	const int ScoreCacheSize = 32;
+
+	float VertexScore(int cachePosition, int remainingTriangles){
+		if (remainingTriangles == 0){
+			return -1.0f;
+		}
+		float score = 0.0f;
+		if (cachePosition >= 0){
+			//The last triangle's vertices get a fixed score, so the next triangle does not just reuse them in place.
+			score = cachePosition < 3 ? 0.75f : std::pow(1.0f - (float) (cachePosition - 3) / (ScoreCacheSize - 3), 1.5f);
+		}
+		return score + 2.0f * std::pow((float) remainingTriangles, -0.5f);
+	}
+
+	void OptimizeVertexCache(std::vector<u16>& indices, size_t vertexCount){
+		const size_t triangleCount = indices.size() / 3;
+		std::vector<int> remaining(vertexCount, 0);
+		std::vector<std::vector<u32>> vertexTriangles(vertexCount);
+		for (size_t t = 0; t < triangleCount; t++){
+			for (int k = 0; k < 3; k++){
+				remaining[indices[t * 3 + k]]++;
+				vertexTriangles[indices[t * 3 + k]].push_back((u32) t);
+			}
+		}
+
+		std::vector<int> cachePosition(vertexCount, -1);
+		std::vector<float> vertexScore(vertexCount);
+		for (size_t v = 0; v < vertexCount; v++){
+			vertexScore[v] = VertexScore(-1, remaining[v]);
+		}
+		std::vector<float> triangleScore(triangleCount);
+		std::vector<bool> emitted(triangleCount, false);
+		for (size_t t = 0; t < triangleCount; t++){
+			triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+		}
+
+		std::vector<u16> result;
+		result.reserve(indices.size());
+		std::vector<int> cache;
+		int best = -1;
+		for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++){
+			//Usually the best triangle is next to the cached vertices. Fall back to a full sweep when it is not.
+			if (best < 0){
+				float bestScore = -1.0f;
+				for (size_t t = 0; t < triangleCount; t++){
+					if (!emitted[t] && triangleScore[t] > bestScore){
+						bestScore = triangleScore[t];
+						best = (int) t;
+					}
+				}
+			}
+
+			emitted[best] = true;
+			for (int k = 0; k < 3; k++){
+				u16 v = indices[best * 3 + k];
+				result.push_back(v);
+				remaining[v]--;
+				std::vector<u32>& list = vertexTriangles[v];
+				list.erase(std::find(list.begin(), list.end(), (u32) best));
+
+				std::vector<int>::iterator found = std::find(cache.begin(), cache.end(), (int) v);
+				if (found != cache.end()){
+					cache.erase(found);
+				}
+				cache.insert(cache.begin(), (int) v);
+			}
+
+			//Vertices pushed out of the scored cache lose their position bonus.
+			std::vector<int> touched(cache.begin(), cache.end());
+			if ((int) cache.size() > ScoreCacheSize){
+				cache.resize(ScoreCacheSize);
+			}
+			for (size_t i = 0; i < touched.size(); i++){
+				cachePosition[touched[i]] = -1;
+			}
+			for (size_t i = 0; i < cache.size(); i++){
+				cachePosition[cache[i]] = (int) i;
+			}
+
+			//Rescore the touched vertices and their triangles, and pick the best of those.
+			best = -1;
+			float bestScore = -1.0f;
+			for (size_t i = 0; i < touched.size(); i++){
+				int v = touched[i];
+				vertexScore[v] = VertexScore(cachePosition[v], remaining[v]);
+			}
+			for (size_t i = 0; i < touched.size(); i++){
+				std::vector<u32>& list = vertexTriangles[touched[i]];
+				for (size_t j = 0; j < list.size(); j++){
+					u32 t = list[j];
+					triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+					if (triangleScore[t] > bestScore){
+						bestScore = triangleScore[t];
+						best = (int) t;
+					}
+				}
+			}
+		}
+		indices.swap(result);
+	}
+
+	//Renumbers the vertices in the order the indices first use them.
+	void OptimizeVertexFetch(std::vector<PackedVertex>& vertices, std::vector<u16>& indices){
+		std::vector<int> remap(vertices.size(), -1);
+		std::vector<PackedVertex> ordered;
+		ordered.reserve(vertices.size());
+		for (size_t i = 0; i < indices.size(); i++){
+			if (remap[indices[i]] < 0){
+				remap[indices[i]] = (int) ordered.size();
+				ordered.push_back(vertices[indices[i]]);
+			}
+			indices[i] = (u16) remap[indices[i]];
+		}
+		vertices.swap(ordered);
+	}
+
+	u32 AlignUp(u32 value){
+		return (value + MeshFileAlignment - 1) & ~(MeshFileAlignment - 1);
+	}
+
+	void WritePadding(FILE* file, u32 from, u32 to){
+		static const u8 zeros[MeshFileAlignment] = { 0 };
+		std::fwrite(zeros, 1, to - from, file);
+	}
+}
+
+int main(int argc, char** argv){
+	if (argc != 3){
+		std::fprintf(stderr, "Usage: %s input.obj output.mesh\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<Vertex> triangles;
+	if (!LoadObj(argv[1], triangles)){
+		return 1;
+	}
+	if (triangles.empty()){
+		std::fprintf(stderr, "%s has no faces\n", argv[1]);
+		return 1;
+	}
+
+	MeshFileHeader header;
+	InitializeMeshFileHeader(header);
+
+	std::vector<PackedVertex> vertices;
+	std::vector<u16> indices;
+	if (!PackMesh(triangles.data(), (int) triangles.size(), vertices, indices, header.positionScale)){
+		std::fprintf(stderr, "%s has more unique vertices than 16-bit indices can reach\n", argv[1]);
+		return 1;
+	}
+
+	float before = CacheMissRatio(indices, 16);
+	OptimizeVertexCache(indices, vertices.size());
+	OptimizeVertexFetch(vertices, indices);
+	float after = CacheMissRatio(indices, 16);
+
+	C3D_FVec minimum, maximum, center;
+	ComputeMeshBounds(triangles.data(), (int) triangles.size(), minimum, maximum, center, header.radius);
+	header.minimum[0] = minimum.x; header.minimum[1] = minimum.y; header.minimum[2] = minimum.z;
+	header.maximum[0] = maximum.x; header.maximum[1] = maximum.y; header.maximum[2] = maximum.z;
+	header.center[0] = center.x; header.center[1] = center.y; header.center[2] = center.z;
+
+	header.vertexCount = (u32) vertices.size();
+	header.indexCount = (u32) indices.size();
+	header.vertexOffset = AlignUp(sizeof(header));
+	header.indexOffset = AlignUp(header.vertexOffset + header.vertexCount * header.stride);
+	const u32 indexEnd = header.indexOffset + header.indexCount * sizeof(u16);
+
+	FILE* file = std::fopen(argv[2], "wb");
+	if (!file){
+		std::fprintf(stderr, "Cannot write %s\n", argv[2]);
+		return 1;
+	}
+	std::fwrite(&header, sizeof(header), 1, file);
+	WritePadding(file, sizeof(header), header.vertexOffset);
+	std::fwrite(vertices.data(), header.stride, vertices.size(), file);
+	WritePadding(file, header.vertexOffset + header.vertexCount * header.stride, header.indexOffset);
+	std::fwrite(indices.data(), sizeof(u16), indices.size(), file);
+	WritePadding(file, indexEnd, AlignUp(indexEnd));
+	std::fclose(file);
+
+	std::printf("%s: %u triangles, %u vertices, %u bytes, ACMR %.3f -> %.3f\n", argv[2], header.indexCount / 3, header.vertexCount, AlignUp(indexEnd), before, after);
+	return 0;
+}
@@ -0,0 +1,127 @@
+//Checks that sleeping physics bodies stay out of the way, and wake up when something lands on them (see
+//PhysicsPool::Sleep() and Engine::CollisionWorld).
+//
+//  sleepcheck
+//
+//Runs a few small scenes through the same physics step Engine::Core runs, without the rest of the engine, and prints
+//each check. Exits with 1 if any check fails. Built by "make host-tools".
+
+#include "../source/engine/collision.h"
+
+using namespace Engine;
+using namespace Entity;
+
+namespace {
+	const float StepLength = 1.0f / 60.0f;
+
+	//Just the pools and the collision world, stepped the way Core::Update() steps them.
+	struct World {
+		HandleTable objects;
+		TransformPool transforms;
+		PhysicsPool physics;
+		CollisionWorld collisions;
+
+		World(){
+			this->physics.SetStepLength(StepLength);
+		}
+
+		//A unit cube with its bottom at the given height.
+		Handle AddCube(float x, float bottom, float z){
+			Handle object = this->objects.Create(0);
+			u32 slot = HandleTable::IndexOf(object);
+			this->transforms.Create(slot);
+			this->transforms.Place(slot, FVec4_New(x, bottom + 0.5f, z, 1.0f), Quat_Identity());
+			PhysicsComponent component;
+			return this->physics.Add(object, component);
+		}
+
+		void Step(){
+			this->transforms.SaveState();
+			this->physics.Accelerate(this->transforms, 0, this->physics.Size());
+			this->collisions.Update(this->physics, this->transforms, StepLength);
+			this->physics.Integrate(this->transforms, 0, this->physics.Size());
+		}
+
+		//Steps until the body is asleep, or the seconds run out. Returns whether it fell asleep.
+		bool StepUntilAsleep(Handle body, float seconds){
+			for (float time = 0.0f; time < seconds; time += StepLength){
+				this->Step();
+				if (this->IsAsleep(body)){
+					return true;
+				}
+			}
+			return false;
+		}
+
+		bool IsAsleep(Handle body) const {
+			return this->physics.asleep[this->physics.IndexOf(body)] != 0;
+		}
+
+		float Height(Handle body) const {
+			return this->transforms.position[HandleTable::IndexOf(this->physics.owner[this->physics.IndexOf(body)])].y;
+		}
+
+		//True if every sleeping body is standing still.
+		bool SleepersStill() const {
+			for (u32 i = 0; i < this->physics.Size(); i++){
+				if (this->physics.asleep[i] && (this->physics.vx[i] != 0.0f || this->physics.vy[i] != 0.0f || this->physics.vz[i] != 0.0f)){
+					return false;
+				}
+			}
+			return true;
+		}
+	};
+
+	u32 failures = 0;
+
+	void Check(const char* name, bool passed){
+		std::printf("%-52s %s\n", name, passed ? "ok" : "FAILED");
+		failures += !passed;
+	}
+}
+
+int main(){
+	{
+		//A sleeping stack, and a body far away that never sleeps, so the collision world keeps running.
+		World world;
+		std::vector<Handle> stack;
+		for (u32 i = 0; i < 10; i++){
+			stack.push_back(world.AddCube(0.0f, (float) i, 0.0f));
+		}
+		bool asleep = world.StepUntilAsleep(stack.back(), 10.0f);
+		Check("stack falls asleep", asleep);
+		Handle mover = world.AddCube(50.0f, 5.0f, 0.0f);
+		bool quiet = true, still = true;
+		for (u32 step = 0; step < 30; step++){
+			world.physics.Set(mover, PhysicsComponent());
+			world.Step();
+			quiet = quiet && world.collisions.PairCount() == 0;
+			still = still && world.SleepersStill();
+		}
+		Check("sleeping pairs skip the narrowphase", quiet);
+		Check("sleeping bodies get no velocity", still);
+		Check("stack stays asleep", world.IsAsleep(stack.front()) && world.IsAsleep(stack.back()));
+	}
+
+	{
+		//A cube dropped onto a sleeping one, next to a sleeping pair of cubes of their own island.
+		World world;
+		Handle bottom = world.AddCube(0.0f, 0.0f, 0.0f);
+		Handle pair = world.AddCube(10.0f, 0.0f, 0.0f);
+		world.AddCube(10.0f, 1.0f, 0.0f);
+		Check("resting cube falls asleep", world.StepUntilAsleep(bottom, 10.0f) && world.IsAsleep(pair));
+		Handle top = world.AddCube(0.2f, 3.0f, 0.0f);
+		bool woke = false;
+		for (u32 step = 0; step < 120 && !woke; step++){
+			world.Step();
+			woke = !world.IsAsleep(bottom);
+		}
+		Check("sleeping cube wakes when a cube lands on it", woke);
+		Check("other islands stay asleep", world.IsAsleep(pair) && world.physics.SleepingCount() == 2);
+		bool settled = world.StepUntilAsleep(top, 10.0f);
+		Check("dropped cube comes to rest on top", settled && world.Height(top) > world.Height(bottom) + 0.9f);
+	}
+
+	std::printf("%u failed\n", failures);
+	return failures > 0 ? 1 : 0;
+}